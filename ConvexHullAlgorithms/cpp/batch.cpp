@@ -0,0 +1,166 @@
+#include "batch.h"
+
+#include <algorithm>
+
+#include "hull.h"
+#include "predicates.h"
+#include "simd.h"
+#include "threadpool.h"
+
+namespace geom {
+
+namespace {
+
+//groups bigger than this go through quickHull()
+const size_t smallGroup = 64;
+
+//below this the extreme point filter costs more than the sort it saves
+const size_t filterFrom = 16;
+
+//groups per task
+const size_t grain = 256;
+
+//counter-clockwise from straight down, so the extremes come out in hull order
+const Point quadrilateral[4] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+/*Hull of at most smallGroup points with Andrew's monotone chain
+*
+* @param chain: out, room for 2 * smallGroup indices relative to pts
+*
+* @return hull size
+*/
+size_t smallHull(const Point* pts, size_t n, size_t* chain)
+{
+    size_t kept[smallGroup];
+    size_t m = 0;
+    bool filtered = false;
+    if (n >= filterFrom) {
+        size_t extreme[4];
+        simd::argmaxDots(&pts[0].x, 2, n, quadrilateral, 4, extreme);
+        Point poly[4];
+        size_t k = 0;
+        for (size_t d = 0; d < 4; d++) {
+            const Point p = pts[extreme[d]];
+            if (k == 0 || p != poly[k - 1]) {
+                poly[k++] = p;
+            }
+        }
+        if (k > 1 && poly[k - 1] == poly[0]) {
+            k--;
+        }
+        if (k >= 3) {
+            uint8_t keep[smallGroup];
+            simd::outsideConvex(&pts[0].x, 2, n, poly, k, keep);
+            for (size_t i = 0; i < n; i++) {
+                kept[m] = i;
+                m += keep[i];
+            }
+            filtered = true;
+        }
+    }
+    if (!filtered) {
+        for (size_t i = 0; i < n; i++) {
+            kept[m++] = i;
+        }
+    }
+
+    //insertion sort is stable, so of repeated points the first copy stays first
+    size_t order[smallGroup];
+    for (size_t i = 0; i < m; i++) {
+        const size_t v = kept[i];
+        size_t j = i;
+        while (j > 0 && lessXY(pts[v], pts[order[j - 1]])) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = v;
+    }
+    size_t unique = 0;
+    for (size_t i = 0; i < m; i++) {
+        if (unique == 0 || pts[order[i]] != pts[order[unique - 1]]) {
+            order[unique++] = order[i];
+        }
+    }
+    m = unique;
+    if (m <= 1) {
+        if (m == 1) {
+            chain[0] = order[0];
+        }
+        return m;
+    }
+
+    //lower chain left to right, then upper chain back, dropping every turn that isn't left
+    size_t h = 0;
+    for (size_t i = 0; i < m; i++) {
+        while (h >= 2 && orient2d(pts[chain[h - 2]], pts[chain[h - 1]], pts[order[i]]) <= 0) {
+            h--;
+        }
+        chain[h++] = order[i];
+    }
+    const size_t lower = h + 1;
+    for (size_t i = m - 1; i-- > 0;) {
+        while (h >= lower && orient2d(pts[chain[h - 2]], pts[chain[h - 1]], pts[order[i]]) <= 0) {
+            h--;
+        }
+        chain[h++] = order[i];
+    }
+    //the upper chain ends where the lower one started
+    return h - 1;
+}
+
+}
+
+HullBatch hullBatch(const Point* pts, const size_t* offsets, size_t groups, TaskPool& pool)
+{
+    HullBatch batch;
+    batch.offsets.assign(groups + 1, 0);
+    if (groups == 0) {
+        return batch;
+    }
+
+    /*Every task keeps the hulls of its groups in a buffer of its own, and
+    * the sizes in offsets[g + 1]. parallelFor() starts its ranges at
+    * multiples of grain, so lo / grain tells the buffers apart.
+    */
+    std::vector<std::vector<size_t>> chunks((groups + grain - 1) / grain);
+    pool.parallelFor(0, groups, grain, [&](size_t lo, size_t hi) {
+        std::vector<size_t>& out = chunks[lo / grain];
+        out.reserve(8 * (hi - lo));
+        size_t chain[2 * smallGroup];
+        for (size_t g = lo; g < hi; g++) {
+            const size_t first = offsets[g];
+            const size_t n = offsets[g + 1] - first;
+            if (n > smallGroup) {
+                const std::vector<size_t> hull = quickHull(pts + first, n);
+                for (size_t k : hull) {
+                    out.push_back(first + k);
+                }
+                batch.offsets[g + 1] = hull.size();
+                continue;
+            }
+            const size_t h = smallHull(pts + first, n, chain);
+            for (size_t k = 0; k < h; k++) {
+                out.push_back(first + chain[k]);
+            }
+            batch.offsets[g + 1] = h;
+        }
+    });
+
+    for (size_t g = 0; g < groups; g++) {
+        batch.offsets[g + 1] += batch.offsets[g];
+    }
+    batch.vertices.resize(batch.offsets[groups]);
+    pool.parallelFor(0, chunks.size(), 1, [&](size_t lo, size_t hi) {
+        for (size_t c = lo; c < hi; c++) {
+            std::copy(chunks[c].begin(), chunks[c].end(), batch.vertices.begin() + batch.offsets[c * grain]);
+        }
+    });
+    return batch;
+}
+
+HullBatch hullBatch(const Point* pts, const size_t* offsets, size_t groups)
+{
+    return hullBatch(pts, offsets, groups, TaskPool::shared());
+}
+
+}
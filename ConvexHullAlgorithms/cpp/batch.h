@@ -0,0 +1,45 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+class TaskPool;
+
+/*Hulls of many point groups, packed the same way as the groups
+*
+* Hull g is vertices[offsets[g]] to vertices[offsets[g + 1] - 1], indices
+* into the packed points in quickHull() order.
+*/
+struct HullBatch
+{
+    std::vector<size_t> offsets;    //groups + 1 entries, offsets[0] = 0
+    std::vector<size_t> vertices;
+};
+
+/*Convex hulls of many small independent groups of points in one call
+*
+* Made for thousands of groups of 8 to 64 points, where calling quickHull()
+* on each costs more in allocation and dispatch than in geometry. Each
+* group is hulled on the stack: for 16 points and up the points strictly
+* inside the quadrilateral of its 4 extremes are dropped with
+* simd::outsideConvex(), then the rest are insertion sorted and walked
+* with Andrew's monotone chain on orient2d(), so the hulls are exact. The
+* groups are split into chunks run on the pool, each chunk's hulls are
+* kept together, and one more parallel pass packs the chunks.
+* Bigger groups still work, they go through quickHull().
+*
+* @param pts: every group's points, one group after another
+* @param offsets: groups + 1 entries, group g is pts[offsets[g]] to pts[offsets[g + 1] - 1]
+* @param pool: pool to run on, the overload without one uses TaskPool::shared()
+*/
+HullBatch hullBatch(const Point* pts, const size_t* offsets, size_t groups, TaskPool& pool);
+HullBatch hullBatch(const Point* pts, const size_t* offsets, size_t groups);
+
+}
+
+#endif
@@ -0,0 +1,795 @@
+/*Benchmark driver for the geometry core
+*
+* Times every engine on the standard point distributions at sizes 10^min to
+* 10^max and prints one row per case with the time per call, throughput,
+* output size and peak resident memory. Each case runs in its own forked
+* process so the peak memory of one case does not hide the next one.
+*
+* items is what throughput is counted in: input points for the hull engines,
+* vertices of both hulls for the polygon engines. output is the hull size, or
+* the iteration count for GJK and EPA. dyn-move counts single point moves in a
+* DynamicHull of n points and win-push single arrivals in a window of the
+* last n points, both report the number of points they hold. kin-move makes
+* dyn-move's moves in a KineticHull and kin-drag moves its hull vertices
+* inward and back, both report the hull size. batch hulls the
+* n points as groups of 32 in one call, batch-qh calls quickHull() on each
+* group, both report the total hull size.
+*
+* hullbench [--min N] [--max N] [--seed S] [--time SEC] [--only a,b] [--dist a,b] [--csv] [--no-fork] [--simd L]
+* hullbench --save FILE [--float32] [--max N] [--dist a] [--seed S]
+* hullbench --file FILE [--time SEC] [--csv]
+* hullbench --stream FILE|- [--raw] [--chunk N]
+*
+* --save writes one generated cloud as a point file, --file times the hull
+* engines directly over the mapped columns of one. --stream hulls a point
+* file, or stdin as text ("x y" pairs) or --raw float64 pairs, in bounded
+* memory and prints the hull.
+*
+* --simd caps the vector kernels at scalar, avx2 or avx512 (default: the
+* best the CPU has) so the levels can be compared on one machine.
+*/
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch.h"
+#include "dischull.h"
+#include "dispatch.h"
+#include "dynamic.h"
+#include "gjk.h"
+#include "hull.h"
+#include "kinetic.h"
+#include "minkowski.h"
+#include "pointfile.h"
+#include "pointgen.h"
+#include "simd.h"
+#include "slidingwindow.h"
+#include "stream.h"
+
+using namespace geom;
+
+namespace {
+
+struct Options
+{
+    size_t minSize = 100;
+    size_t maxSize = 10000000;
+    uint64_t seed = 1;
+    double minTime = 0.2;      //seconds spent timing each case, at least one call is made
+    std::string only;          //comma separated bench names, empty means all
+    std::string dists;         //comma separated distribution names, empty means all
+    bool csv = false;
+    bool fork = true;
+    std::string save;          //write a point file instead of benchmarking
+    bool float32 = false;
+    std::string file;          //benchmark a mapped point file
+    std::string stream;        //hull a point file or stdin chunk by chunk
+    bool raw = false;
+    size_t chunk = 1 << 20;
+    simd::Level simd = simd::detected();
+};
+
+//inputs of one case, built outside the timed region
+struct Workload
+{
+    std::vector<Point> a;
+    std::vector<Point> b;
+    std::vector<IntPoint> ia;       //the integer engines' inputs
+    std::vector<IntPoint> ib;
+    GjkCache cache;
+    SupportMap mapA;
+    SupportMap mapB;
+    Motion motionB;
+    std::vector<Disc> discs;
+    std::vector<size_t> offsets;    //batch's groups
+    DiscHull roundA;
+    DiscHull roundB;
+    DynamicHull dynamic;
+    KineticHull kinetic;
+    SlidingWindowHull window;
+    size_t next = 0;                //the next point dyn-move or kin-move moves, or win-push pushes
+    size_t items = 0;               //what throughput is counted in
+    std::function<size_t()> run;    //returns the output size
+};
+
+struct Bench
+{
+    const char* name;
+    void (*setup)(Workload& w, Distribution d, size_t n, uint64_t seed);
+};
+
+struct Result
+{
+    double seconds;   //best time of one call
+    size_t calls;
+    size_t output;
+    size_t items;
+};
+
+//hull vertices of a generated cloud, for the engines that take convex polygons
+std::vector<Point> hullOf(Distribution d, size_t n, uint64_t seed)
+{
+    const std::vector<Point> pts = generatePoints(d, n, seed);
+    std::vector<Point> out;
+    for (size_t i : quickHull(pts.data(), pts.size())) {
+        out.push_back(pts[i]);
+    }
+    return out;
+}
+
+void setupQuickHull(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.items = n;
+    w.run = [&w]() { return quickHull(w.a.data(), w.a.size()).size(); };
+}
+
+//the cloud snapped to an integer grid of 2^24 steps per unit, well inside int32
+std::vector<IntPoint> gridOf(const std::vector<Point>& pts)
+{
+    std::vector<IntPoint> out(pts.size());
+    for (size_t i = 0; i < pts.size(); i++) {
+        out[i] = { (int32_t)std::lround(pts[i].x * 16777216.0), (int32_t)std::lround(pts[i].y * 16777216.0) };
+    }
+    return out;
+}
+
+std::vector<IntPoint> intHullOf(Distribution d, size_t n, uint64_t seed)
+{
+    const std::vector<IntPoint> pts = gridOf(generatePoints(d, n, seed));
+    std::vector<IntPoint> out;
+    for (size_t i : quickHull(pts.data(), pts.size())) {
+        out.push_back(pts[i]);
+    }
+    return out;
+}
+
+void setupQuickHullInt(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.ia = gridOf(generatePoints(d, n, seed));
+    w.items = n;
+    w.run = [&w]() { return quickHull(w.ia.data(), w.ia.size()).size(); };
+}
+
+void setupQuickHullParallel(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.items = n;
+    w.run = [&w]() { return quickHullParallel(w.a.data(), w.a.size()).size(); };
+}
+
+void setupChanHull(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.items = n;
+    w.run = [&w]() { return chanHull(w.a.data(), w.a.size()).size(); };
+}
+
+//the same engines behind the Akl-Toussaint filter, the filter pass is timed too
+void setupQuickHullFiltered(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.items = n;
+    w.run = [&w]() { return convexHull<Filtered<QuickHull>>(w.a.data(), w.a.size()).size(); };
+}
+
+void setupChanHullFiltered(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.items = n;
+    w.run = [&w]() { return convexHull<Filtered<ChanHull>>(w.a.data(), w.a.size()).size(); };
+}
+
+void setupMinkowskiSum(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = hullOf(d, n, seed);
+    w.b = hullOf(d, n, seed + 1);
+    w.items = w.a.size() + w.b.size();
+    w.run = [&w]() { return minkowskiSum(w.a.data(), w.a.size(), w.b.data(), w.b.size()).size(); };
+}
+
+void setupMinkowskiSumInt(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.ia = intHullOf(d, n, seed);
+    w.ib = intHullOf(d, n, seed + 1);
+    w.items = w.ia.size() + w.ib.size();
+    w.run = [&w]() { return minkowskiSum(w.ia.data(), w.ia.size(), w.ib.data(), w.ib.size()).size(); };
+}
+
+/*Each call moves one point of a built DynamicHull to its place in a second
+* cloud, the next call moves the next point, and every point swaps back on
+* the next pass, so the hull keeps the same distribution
+*/
+void setupDynamicMove(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.b = generatePoints(d, n, seed + 1);
+    w.dynamic.build(w.a.data(), w.a.size());
+    w.items = 1;
+    w.run = [&w]() {
+        const size_t i = w.next++ % w.a.size();
+        w.dynamic.move(w.a[i], w.b[i], i);
+        std::swap(w.a[i], w.b[i]);
+        return w.dynamic.size();
+    };
+}
+
+//dyn-move's moves on a KineticHull, where almost every one is an interior point
+void setupKineticMove(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.b = generatePoints(d, n, seed + 1);
+    w.kinetic.build(w.a.data(), w.a.size());
+    w.items = 1;
+    w.run = [&w]() {
+        const size_t i = w.next++ % w.a.size();
+        w.kinetic.move(i, w.b[i]);
+        std::swap(w.a[i], w.b[i]);
+        return w.kinetic.vertices().size();
+    };
+}
+
+/*Each pair of calls drags a hull vertex of a KineticHull 2% toward the
+* origin and back, the case that has to find the points behind it
+*/
+void setupKineticDrag(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.kinetic.build(w.a.data(), w.a.size());
+    w.items = 1;
+    w.run = [&w, dragged = (size_t)0]() mutable {
+        const size_t step = w.next++;
+        if (step % 2 == 0) {
+            const std::vector<size_t>& hull = w.kinetic.vertices();
+            dragged = hull[(step / 2) % hull.size()];
+            w.kinetic.move(dragged, 0.98 * w.a[dragged]);
+        }
+        else {
+            w.kinetic.move(dragged, w.a[dragged]);
+        }
+        return w.kinetic.vertices().size();
+    };
+}
+
+//a full window of the last n points, each call pushes the next point of a
+//second cloud and evicts the oldest, cycling through both clouds
+void setupWindowPush(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.b = generatePoints(d, n, seed + 1);
+    w.window.setLimits(n, std::numeric_limits<double>::infinity());
+    for (size_t i = 0; i < n; i++) {
+        w.window.push(w.a[i], (double)i, i);
+    }
+    w.next = n;
+    w.items = 1;
+    w.run = [&w]() {
+        const size_t i = w.next++;
+        const std::vector<Point>& from = (i / w.a.size()) % 2 ? w.b : w.a;
+        w.window.push(from[i % w.a.size()], (double)i, i);
+        return w.window.size();
+    };
+}
+
+//B is shifted clear of A so the query has a distance to converge to
+void setupGjkPair(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = hullOf(d, n, seed);
+    w.b = hullOf(d, n, seed + 1);
+    for (Point& p : w.b) {
+        p.x += 20.0;
+    }
+    w.items = w.a.size() + w.b.size();
+}
+
+void setupGjk(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupGjkPair(w, d, n, seed);
+    w.run = [&w]() { return (size_t)gjk(w.a.data(), w.a.size(), w.b.data(), w.b.size()).iterations; };
+}
+
+//the way the app calls it: same pair every frame with a kept cache
+void setupGjkWarm(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupGjkPair(w, d, n, seed);
+    w.run = [&w]() { return (size_t)gjk(w.a.data(), w.a.size(), w.b.data(), w.b.size(), &w.cache).iterations; };
+}
+
+//the same pair through SupportMaps built outside the timed region
+void setupGjkMap(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupGjkPair(w, d, n, seed);
+    w.mapA.build(w.a.data(), w.a.size());
+    w.mapB.build(w.b.data(), w.b.size());
+    w.run = [&w]() { return (size_t)gjk(w.mapA, w.mapB).iterations; };
+}
+
+//B overlaps A by about a quarter of its width, so EPA has a depth to find
+void setupEpa(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = hullOf(d, n, seed);
+    w.b = hullOf(d, n, seed + 1);
+    for (Point& p : w.b) {
+        p.x += 1.5;
+    }
+    w.items = w.a.size() + w.b.size();
+    w.run = [&w]() { return (size_t)epa(w.a.data(), w.a.size(), w.b.data(), w.b.size()).iterations; };
+}
+
+//B starts as for gjk, 20 right of A, and flies through it in one unit of time turning
+//a quarter turn, the way the app's TOI graph moves
+void setupTimeOfImpact(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupGjkPair(w, d, n, seed);
+    w.mapA.build(w.a.data(), w.a.size());
+    w.mapB.build(w.b.data(), w.b.size());
+    w.motionB.center = { 20, 0 };
+    w.motionB.velocity = { -40, 0 };
+    w.motionB.angularVelocity = 1.5707963267948966;
+    w.run = [&w]() {
+        return (size_t)timeOfImpact(w.mapA, Motion(), w.mapB, w.motionB, 1.0, 1e-6).iterations;
+    };
+}
+
+//the cloud's points as discs with radii up to 0.05, a twentieth of the square's half width
+void setupDiscHull(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    const std::vector<Point> pts = generatePoints(d, n, seed);
+    const std::vector<Point> radii = generatePoints(Distribution::UniformSquare, n, seed + 1);
+    w.discs.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        w.discs[i] = { pts[i], 0.05 * std::fabs(radii[i].x) };
+    }
+    w.items = n;
+    w.run = [&w]() { return DiscHull(w.discs.data(), w.discs.size()).size(); };
+}
+
+//the gjk pair with both hulls grown by 0.5, as arcs rather than vertices
+void setupGjkRound(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupGjkPair(w, d, n, seed);
+    w.roundA = DiscHull::rounded(w.a.data(), w.a.size(), 0.5);
+    w.roundB = DiscHull::rounded(w.b.data(), w.b.size(), 0.5);
+    w.run = [&w]() { return (size_t)gjk(w.roundA, w.roundB).iterations; };
+}
+
+//the cloud cut into groups of 32 points, as many small footprints would be
+void setupBatchGroups(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = generatePoints(d, n, seed);
+    w.offsets.clear();
+    for (size_t i = 0; i < n; i += 32) {
+        w.offsets.push_back(i);
+    }
+    w.offsets.push_back(n);
+    w.items = n;
+}
+
+void setupBatch(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupBatchGroups(w, d, n, seed);
+    w.run = [&w]() { return hullBatch(w.a.data(), w.offsets.data(), w.offsets.size() - 1).vertices.size(); };
+}
+
+void setupBatchQuickHull(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    setupBatchGroups(w, d, n, seed);
+    w.run = [&w]() {
+        size_t total = 0;
+        for (size_t g = 0; g + 1 < w.offsets.size(); g++) {
+            total += quickHull(w.a.data() + w.offsets[g], w.offsets[g + 1] - w.offsets[g]).size();
+        }
+        return total;
+    };
+}
+
+void setupMinkowskiDifference(Workload& w, Distribution d, size_t n, uint64_t seed)
+{
+    w.a = hullOf(d, n, seed);
+    w.b = hullOf(d, n, seed + 1);
+    w.items = w.a.size() + w.b.size();
+    w.run = [&w]() { return minkowskiDifference(w.a.data(), w.a.size(), w.b.data(), w.b.size()).size(); };
+}
+
+const Bench benches[] = {
+    { "qhull",     setupQuickHull },
+    { "qhull-i32", setupQuickHullInt },
+    { "qhull-mt",  setupQuickHullParallel },
+    { "chan",      setupChanHull },
+    { "qhull-at",  setupQuickHullFiltered },
+    { "chan-at",   setupChanHullFiltered },
+    { "discs",     setupDiscHull },
+    { "batch",     setupBatch },
+    { "batch-qh",  setupBatchQuickHull },
+    { "msum",      setupMinkowskiSum },
+    { "msum-i32",  setupMinkowskiSumInt },
+    { "mdiff",     setupMinkowskiDifference },
+    { "gjk",       setupGjk },
+    { "gjk-warm",  setupGjkWarm },
+    { "gjk-map",   setupGjkMap },
+    { "toi",       setupTimeOfImpact },
+    { "gjk-round", setupGjkRound },
+    { "epa",       setupEpa },
+    { "dyn-move",  setupDynamicMove },
+    { "kin-move",  setupKineticMove },
+    { "kin-drag",  setupKineticDrag },
+    { "win-push",  setupWindowPush },
+};
+
+bool listed(const std::string& list, const char* name)
+{
+    if (list.empty()) {
+        return true;
+    }
+    const std::string padded = "," + list + ",";
+    return padded.find("," + std::string(name) + ",") != std::string::npos;
+}
+
+//independent of the bench so every engine sees the same points for a case
+uint64_t caseSeed(uint64_t seed, Distribution d, size_t n)
+{
+    return seed * 0x9E3779B97F4A7C15ull + (uint64_t)d * 0x100000001B3ull + n;
+}
+
+/*Times w.run, batching calls until one sample is long enough for the clock
+* and keeping the fastest sample
+*/
+Result measure(Workload& w, double minTime)
+{
+    using clock = std::chrono::steady_clock;
+    Result r = { 1e300, 0, 0, w.items };
+    size_t batch = 1;
+    const clock::time_point start = clock::now();
+    for (;;) {
+        const clock::time_point t0 = clock::now();
+        for (size_t i = 0; i < batch; i++) {
+            r.output = w.run();
+        }
+        const double sample = std::chrono::duration<double>(clock::now() - t0).count();
+        r.calls += batch;
+        if (sample / batch < r.seconds) {
+            r.seconds = sample / batch;
+        }
+        if (std::chrono::duration<double>(clock::now() - start).count() >= minTime) {
+            break;
+        }
+        if (sample < 1e-3) {
+            batch *= 2;
+        }
+    }
+    return r;
+}
+
+Result runCase(const Bench& bench, Distribution d, size_t n, const Options& opt)
+{
+    Workload w;
+    bench.setup(w, d, n, caseSeed(opt.seed, d, n));
+    return measure(w, opt.minTime);
+}
+
+//peak resident set in KiB, of this process or of the waited-for children
+long peakKiB(int who)
+{
+    rusage usage;
+    getrusage(who, &usage);
+    return usage.ru_maxrss;
+}
+
+/*Runs one case in a child process and returns false if it died (usually
+* out of memory at the biggest sizes)
+*/
+bool runForked(const Bench& bench, Distribution d, size_t n, const Options& opt, Result& r, long& peak)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        const Result res = runCase(bench, d, n, opt);
+        const bool ok = write(fds[1], &res, sizeof(res)) == (ssize_t)sizeof(res);
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    const bool got = read(fds[0], &r, sizeof(r)) == (ssize_t)sizeof(r);
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage;
+    wait4(pid, &status, 0, &usage);
+    peak = usage.ru_maxrss;
+    return got && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool parseSize(const char* s, size_t& out)
+{
+    char* end = nullptr;
+    const double v = std::strtod(s, &end);
+    if (end == s || *end != '\0' || v < 1) {
+        return false;
+    }
+    out = (size_t)(v + 0.5);
+    return true;
+}
+
+void usage(const char* argv0)
+{
+    std::fprintf(stderr,
+        "usage: %s [--min N] [--max N] [--seed S] [--time SEC] [--only a,b] [--dist a,b] [--csv] [--no-fork] [--simd L]\n"
+        "       %s --save FILE [--float32] [--max N] [--dist a] [--seed S]\n"
+        "       %s --file FILE [--time SEC] [--csv]\n"
+        "       %s --stream FILE|- [--raw] [--chunk N]\n"
+        "  sizes go up by powers of ten from --min (default 1e2) to --max (default 1e7)\n"
+        "  simd levels: scalar avx2 avx512, this CPU has %s\n"
+        "  benches:", argv0, argv0, argv0, argv0, simd::levelName(simd::detected()));
+    for (const Bench& b : benches) {
+        std::fprintf(stderr, " %s", b.name);
+    }
+    std::fprintf(stderr, "\n  distributions:");
+    for (Distribution d : allDistributions) {
+        std::fprintf(stderr, " %s", distributionName(d));
+    }
+    std::fprintf(stderr, "\n");
+}
+
+bool parseLevel(const char* s, simd::Level& out)
+{
+    for (simd::Level level : { simd::Level::Scalar, simd::Level::Avx2, simd::Level::Avx512 }) {
+        if (std::strcmp(s, simd::levelName(level)) == 0) {
+            out = level;
+            return level <= simd::detected();
+        }
+    }
+    return false;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--min" && hasValue) {
+            if (!parseSize(argv[++i], opt.minSize)) return false;
+        }
+        else if (arg == "--max" && hasValue) {
+            if (!parseSize(argv[++i], opt.maxSize)) return false;
+        }
+        else if (arg == "--seed" && hasValue) {
+            opt.seed = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (arg == "--time" && hasValue) {
+            opt.minTime = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--only" && hasValue) {
+            opt.only = argv[++i];
+        }
+        else if (arg == "--dist" && hasValue) {
+            opt.dists = argv[++i];
+        }
+        else if (arg == "--csv") {
+            opt.csv = true;
+        }
+        else if (arg == "--no-fork") {
+            opt.fork = false;
+        }
+        else if (arg == "--save" && hasValue) {
+            opt.save = argv[++i];
+        }
+        else if (arg == "--float32") {
+            opt.float32 = true;
+        }
+        else if (arg == "--file" && hasValue) {
+            opt.file = argv[++i];
+        }
+        else if (arg == "--stream" && hasValue) {
+            opt.stream = argv[++i];
+        }
+        else if (arg == "--raw") {
+            opt.raw = true;
+        }
+        else if (arg == "--chunk" && hasValue) {
+            if (!parseSize(argv[++i], opt.chunk)) return false;
+        }
+        else if (arg == "--simd" && hasValue) {
+            if (!parseLevel(argv[++i], opt.simd)) return false;
+        }
+        else {
+            return false;
+        }
+    }
+    return opt.minSize <= opt.maxSize;
+}
+
+}
+
+void printHeader(const Options& opt)
+{
+    if (opt.csv) {
+        std::printf("bench,dist,n,items,output,calls,seconds,mitems_per_s,peak_mib\n");
+    }
+    else {
+        std::printf("%-9s %-9s %10s %10s %9s %12s %12s %10s\n",
+            "bench", "dist", "n", "items", "output", "us/call", "Mitems/s", "peak MiB");
+    }
+}
+
+void printRow(const Options& opt, const char* bench, const char* dist, size_t n, const Result& r, long peak)
+{
+    const double rate = r.items / r.seconds / 1e6;
+    const double mib = peak / 1024.0;
+    if (opt.csv) {
+        std::printf("%s,%s,%zu,%zu,%zu,%zu,%.9g,%.6g,%.1f\n",
+            bench, dist, n, r.items, r.output, r.calls, r.seconds, rate, mib);
+    }
+    else {
+        std::printf("%-9s %-9s %10zu %10zu %9zu %12.3f %12.2f %10.1f\n",
+            bench, dist, n, r.items, r.output, r.seconds * 1e6, rate, mib);
+    }
+    std::fflush(stdout);
+}
+
+//--save: one cloud of the first listed distribution at --max points
+int savePoints(const Options& opt)
+{
+    Distribution d = Distribution::UniformSquare;
+    for (Distribution c : allDistributions) {
+        if (!opt.dists.empty() && listed(opt.dists, distributionName(c))) {
+            d = c;
+            break;
+        }
+    }
+    const std::vector<Point> pts = generatePoints(d, opt.maxSize, caseSeed(opt.seed, d, opt.maxSize));
+    if (!writePointFile(opt.save.c_str(), pts.data(), pts.size(), opt.float32 ? Scalar::Float32 : Scalar::Float64)) {
+        std::fprintf(stderr, "cannot write %s\n", opt.save.c_str());
+        return 1;
+    }
+    std::printf("wrote %zu %s points to %s\n", pts.size(), distributionName(d), opt.save.c_str());
+    return 0;
+}
+
+//runs hull(x, y, n) on whichever columns the file has
+template <class Hull>
+size_t hullOfFile(const MappedPoints& file, Hull hull)
+{
+    if (file.scalar() == Scalar::Float32) {
+        return hull(file.xFloat32(), file.yFloat32(), file.size()).size();
+    }
+    return hull(file.xFloat64(), file.yFloat64(), file.size()).size();
+}
+
+//--file: the engines that take columns, run in place on the mapping
+int benchFile(const Options& opt)
+{
+    using clock = std::chrono::steady_clock;
+    MappedPoints file;
+    const clock::time_point t0 = clock::now();
+    if (!file.open(opt.file.c_str())) {
+        std::fprintf(stderr, "%s\n", file.error().c_str());
+        return 1;
+    }
+    const double openSeconds = std::chrono::duration<double>(clock::now() - t0).count();
+    if (!opt.csv) {
+        std::printf("# %s: %zu float%d points, mapped in %.3f ms\n", opt.file.c_str(), file.size(),
+            file.scalar() == Scalar::Float32 ? 32 : 64, openSeconds * 1e3);
+    }
+    printHeader(opt);
+
+    //no fork here, so the peak memory column is cumulative
+    Workload w;
+    w.items = file.size();
+    w.run = [&file]() {
+        return hullOfFile(file, [](auto x, auto y, size_t n) { return quickHull(x, y, n); });
+    };
+    Result r = measure(w, opt.minTime);
+    printRow(opt, "qhull", "file", file.size(), r, peakKiB(RUSAGE_SELF));
+
+    w.run = [&file]() {
+        return hullOfFile(file, [](auto x, auto y, size_t n) { return chanHull(x, y, n); });
+    };
+    r = measure(w, opt.minTime);
+    printRow(opt, "chan", "file", file.size(), r, peakKiB(RUSAGE_SELF));
+    return 0;
+}
+
+//--stream: one pass, prints the hull vertices as "index x y" after a summary line
+int streamInput(const Options& opt)
+{
+    using clock = std::chrono::steady_clock;
+    StreamingHull hull(opt.chunk);
+    std::string error;
+    const clock::time_point t0 = clock::now();
+    const bool ok = opt.stream == "-"
+        ? streamHull(stdin, opt.raw ? StreamFormat::Interleaved64 : StreamFormat::Text, hull, &error)
+        : streamPointFile(opt.stream.c_str(), hull, &error);
+    const double seconds = std::chrono::duration<double>(clock::now() - t0).count();
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::printf("# %llu points, %zu hull vertices, %.3f s, %.2f Mpoints/s, peak %.1f MiB\n",
+        (unsigned long long)hull.count(), hull.vertices().size(), seconds,
+        hull.count() / seconds / 1e6, peakKiB(RUSAGE_SELF) / 1024.0);
+    for (size_t i = 0; i < hull.vertices().size(); i++) {
+        std::printf("%llu %.17g %.17g\n", (unsigned long long)hull.indices()[i],
+            hull.vertices()[i].x, hull.vertices()[i].y);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+    simd::setLevel(opt.simd);
+
+    if (!opt.save.empty()) {
+        return savePoints(opt);
+    }
+    if (!opt.file.empty()) {
+        return benchFile(opt);
+    }
+    if (!opt.stream.empty()) {
+        return streamInput(opt);
+    }
+
+    if (!opt.csv) {
+        std::printf("# seed %llu, simd %s\n", (unsigned long long)opt.seed, simd::levelName(simd::active()));
+    }
+    printHeader(opt);
+
+    for (const Bench& bench : benches) {
+        if (!listed(opt.only, bench.name)) {
+            continue;
+        }
+        for (Distribution d : allDistributions) {
+            if (!listed(opt.dists, distributionName(d))) {
+                continue;
+            }
+            for (size_t n = opt.minSize; n <= opt.maxSize; n *= 10) {
+                Result r;
+                long peak = 0;
+                bool ok = true;
+                if (opt.fork) {
+                    ok = runForked(bench, d, n, opt, r, peak);
+                }
+                else {
+                    r = runCase(bench, d, n, opt);
+                    peak = peakKiB(RUSAGE_SELF);
+                }
+
+                if (!ok) {
+                    std::printf(opt.csv ? "%s,%s,%zu,,,,,,\n" : "%-9s %-9s %10zu     failed\n",
+                        bench.name, distributionName(d), n);
+                    std::fflush(stdout);
+                    continue;
+                }
+                printRow(opt, bench.name, distributionName(d), n, r, peak);
+                if (n > opt.maxSize / 10) {
+                    break;
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "broadphase.h"
+
+#include <algorithm>
+
+#include "threadpool.h"
+
+namespace geom {
+
+Aabb boundsOf(const Point* p, size_t n)
+{
+    if (n == 0) {
+        return { { 0, 0 }, { 0, 0 } };
+    }
+    Aabb box = { p[0], p[0] };
+    for (size_t i = 1; i < n; i++) {
+        box.min.x = std::min(box.min.x, p[i].x);
+        box.min.y = std::min(box.min.y, p[i].y);
+        box.max.x = std::max(box.max.x, p[i].x);
+        box.max.y = std::max(box.max.y, p[i].y);
+    }
+    return box;
+}
+
+size_t SweepAndPrune::add(const Aabb& box)
+{
+    size_t id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        boxes[id] = box;
+        alive[id] = true;
+    }
+    else {
+        id = boxes.size();
+        boxes.push_back(box);
+        alive.push_back(true);
+    }
+    endpoints.push_back({ box.min.x, id, true });
+    endpoints.push_back({ box.max.x, id, false });
+    dirty = true;
+    return id;
+}
+
+void SweepAndPrune::remove(size_t id)
+{
+    alive[id] = false;
+    freeIds.push_back(id);
+    endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+        [id](const Endpoint& e) { return e.id == id; }), endpoints.end());
+}
+
+void SweepAndPrune::update(size_t id, const Aabb& box)
+{
+    boxes[id] = box;
+    dirty = true;
+}
+
+void SweepAndPrune::findPairs(std::vector<std::pair<size_t, size_t>>& pairs)
+{
+    if (dirty) {
+        for (Endpoint& e : endpoints) {
+            e.value = e.isMin ? boxes[e.id].min.x : boxes[e.id].max.x;
+        }
+        //insertion sort, mins before maxes at equal values so touching boxes count
+        for (size_t i = 1; i < endpoints.size(); i++) {
+            const Endpoint e = endpoints[i];
+            size_t j = i;
+            while (j > 0 && (endpoints[j - 1].value > e.value ||
+                   (endpoints[j - 1].value == e.value && !endpoints[j - 1].isMin && e.isMin))) {
+                endpoints[j] = endpoints[j - 1];
+                j--;
+            }
+            endpoints[j] = e;
+        }
+        dirty = false;
+    }
+
+    std::vector<size_t> active;
+    for (const Endpoint& e : endpoints) {
+        if (!e.isMin) {
+            active.erase(std::find(active.begin(), active.end(), e.id));
+            continue;
+        }
+        const Aabb& box = boxes[e.id];
+        for (size_t other : active) {
+            const Aabb& o = boxes[other];
+            if (box.min.y <= o.max.y && o.min.y <= box.max.y) {
+                pairs.push_back({ std::min(e.id, other), std::max(e.id, other) });
+            }
+        }
+        active.push_back(e.id);
+    }
+}
+
+Aabb CollisionWorld::paddedBounds(size_t id) const
+{
+    Aabb box = boundsOf(bodies[id].hull.data(), bodies[id].hull.size());
+    box.min = box.min - Point{ padding, padding };
+    box.max = box.max + Point{ padding, padding };
+    return box;
+}
+
+size_t CollisionWorld::addBody(std::vector<Point> hull)
+{
+    Body b = { std::move(hull), true };
+    const size_t id = broad.add(boundsOf(b.hull.data(), b.hull.size()));
+    if (id == bodies.size()) {
+        bodies.push_back(std::move(b));
+    }
+    else {
+        bodies[id] = std::move(b);
+    }
+    broad.update(id, paddedBounds(id));
+    return id;
+}
+
+void CollisionWorld::removeBody(size_t id)
+{
+    bodies[id].alive = false;
+    bodies[id].hull.clear();
+    broad.remove(id);
+}
+
+void CollisionWorld::setBody(size_t id, std::vector<Point> hull)
+{
+    bodies[id].hull = std::move(hull);
+    broad.update(id, paddedBounds(id));
+}
+
+void CollisionWorld::translateBody(size_t id, const Point& delta)
+{
+    for (Point& p : bodies[id].hull) {
+        p = p + delta;
+    }
+    broad.update(id, paddedBounds(id));
+}
+
+std::vector<CollisionWorld::Contact> CollisionWorld::query(double margin, TaskPool* pool)
+{
+    //each box grows by half the margin, so boxes of bodies within margin still overlap
+    if (margin / 2 != padding) {
+        padding = margin / 2;
+        for (size_t id = 0; id < bodies.size(); id++) {
+            if (bodies[id].alive) {
+                broad.update(id, paddedBounds(id));
+            }
+        }
+    }
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    broad.findPairs(pairs);
+    candidates = pairs.size();
+
+    //caches of pairs that dropped out of the broad phase are let go here
+    std::unordered_map<uint64_t, GjkCache> kept;
+    kept.reserve(pairs.size());
+    std::vector<GjkCache*> pairCache(pairs.size());
+    for (size_t k = 0; k < pairs.size(); k++) {
+        const uint64_t key = (uint64_t(pairs[k].first) << 32) | uint64_t(pairs[k].second);
+        auto old = caches.find(key);
+        pairCache[k] = &(kept[key] = old != caches.end() ? old->second : GjkCache());
+    }
+    caches.swap(kept);
+
+    std::vector<GjkResult> results(pairs.size());
+    auto narrow = [&](size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; k++) {
+            const Body& a = bodies[pairs[k].first];
+            const Body& b = bodies[pairs[k].second];
+            results[k] = gjk(a.hull.data(), a.hull.size(), b.hull.data(), b.hull.size(), pairCache[k]);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(0, pairs.size(), 256, narrow);
+    }
+    else {
+        narrow(0, pairs.size());
+    }
+
+    std::vector<Contact> contacts;
+    for (size_t k = 0; k < pairs.size(); k++) {
+        if (results[k].intersecting || results[k].distance <= margin) {
+            contacts.push_back({ pairs[k].first, pairs[k].second, results[k] });
+        }
+    }
+    return contacts;
+}
+
+}
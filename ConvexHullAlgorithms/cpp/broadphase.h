@@ -0,0 +1,113 @@
+#ifndef _BROADPHASE_H
+#define _BROADPHASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+#include "gjk.h"
+
+namespace geom {
+
+class TaskPool;
+
+struct Aabb
+{
+    Point min;
+    Point max;
+};
+
+Aabb boundsOf(const Point* p, size_t n);
+
+inline bool overlaps(const Aabb& a, const Aabb& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+/*Incremental sort-and-sweep over the x extents of a set of boxes
+*
+* The endpoint list stays sorted between calls and is fixed up with an
+* insertion sort, which is close to linear when boxes only move a little
+* each frame. The sweep then only tests y overlap for boxes whose x
+* ranges already overlap.
+*/
+class SweepAndPrune
+{
+public:
+    //returns the id of the new box, ids of removed boxes get reused
+    size_t add(const Aabb& box);
+    void   remove(size_t id);
+    void   update(size_t id, const Aabb& box);
+
+    //appends every overlapping pair, as (lower id, higher id)
+    void   findPairs(std::vector<std::pair<size_t, size_t>>& pairs);
+
+private:
+    struct Endpoint
+    {
+        double value;
+        size_t id;
+        bool   isMin;
+    };
+
+    std::vector<Endpoint> endpoints;
+    std::vector<Aabb>     boxes;
+    std::vector<bool>     alive;
+    std::vector<size_t>   freeIds;
+    bool                  dirty = false;
+};
+
+/*Many convex bodies with a broad phase in front of GJK
+*
+* Candidate pairs come from SweepAndPrune over the body bounds and only
+* those get the exact GJK test, each pair keeping its own warm start cache
+* for as long as its boxes keep overlapping.
+*/
+class CollisionWorld
+{
+public:
+    struct Contact
+    {
+        size_t    a, b;
+        GjkResult result;
+    };
+
+    //hull is the body's convex polygon, returns the body id
+    size_t addBody(std::vector<Point> hull);
+    void   removeBody(size_t id);
+    void   setBody(size_t id, std::vector<Point> hull);
+    void   translateBody(size_t id, const Point& delta);
+
+    const std::vector<Point>& body(size_t id) const { return bodies[id].hull; }
+
+    /*Every pair of bodies closer than margin (margin 0 = intersecting pairs)
+    *
+    * @param pool: runs the GJK tests in parallel when given
+    */
+    std::vector<Contact> query(double margin = 0, TaskPool* pool = nullptr);
+
+    //pairs that reached GJK in the last query
+    size_t candidateCount() const { return candidates; }
+
+private:
+    struct Body
+    {
+        std::vector<Point> hull;
+        bool               alive;
+    };
+
+    Aabb paddedBounds(size_t id) const;
+
+    std::vector<Body>                      bodies;
+    SweepAndPrune                          broad;
+    std::unordered_map<uint64_t, GjkCache> caches;
+    double                                 padding = 0;
+    size_t                                 candidates = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,312 @@
+#include "hull.h"
+
+#include <algorithm>
+
+#include "predicates.h"
+
+namespace geom {
+
+namespace {
+
+/*Hulls of the consecutive groups pts[g*m, (g+1)*m) of the input.
+*
+* verts[start[g], start[g+1]) is the hull of group g, counter-clockwise from
+* its lowest-x point with no collinear vertices. points holds their
+* coordinates so the tangent searches don't chase indices.
+*/
+struct GroupHulls
+{
+    std::vector<size_t> verts;
+    std::vector<Point>  points;
+    std::vector<size_t> start;
+};
+
+//position and group of the current vertex of the wrap
+struct Cursor
+{
+    size_t group;
+    size_t pos;
+};
+
+inline double dist2(const Point& a, const Point& b)
+{
+    const Point d = b - a;
+    return dot(d, d);
+}
+
+//whether c makes a better next hull vertex after p than best: further
+//clockwise, or collinear and further away so collinear points are skipped
+inline bool betterTurn(const Point& p, const Point& best, const Point& c)
+{
+    const double o = orient2d(p, best, c);
+    return o < 0 || (o == 0 && dist2(p, c) > dist2(p, best));
+}
+
+struct Vertex
+{
+    Point  p;
+    size_t index;
+};
+
+/*Andrew's monotone chain over the candidates of one group, appended to out
+*
+* @param work: candidate points, gets sorted
+*/
+void groupHull(std::vector<Vertex>& work, std::vector<size_t>& chain, GroupHulls& out)
+{
+    std::sort(work.begin(), work.end(), [](const Vertex& a, const Vertex& b) { return lessXY(a.p, b.p); });
+
+    //chain holds positions in work
+    chain.clear();
+    auto turnsLeft = [&](size_t i) {
+        return orient2d(work[chain[chain.size() - 2]].p, work[chain.back()].p, work[i].p) > 0;
+    };
+    for (size_t i = 0; i < work.size(); i++) {
+        while (chain.size() >= 2 && !turnsLeft(i)) {
+            chain.pop_back();
+        }
+        chain.push_back(i);
+    }
+    const size_t lowerEnd = chain.size() + 1;
+    for (size_t i = work.size() - 1; i-- > 0;) {
+        while (chain.size() >= lowerEnd && !turnsLeft(i)) {
+            chain.pop_back();
+        }
+        chain.push_back(i);
+    }
+    //the upper chain ends on the first vertex again, unless everything was one point
+    if (chain.size() > 1) {
+        chain.pop_back();
+    }
+    for (size_t i : chain) {
+        out.verts.push_back(work[i].index);
+        out.points.push_back(work[i].p);
+    }
+}
+
+//QuickHull of the input points [lo, hi), with its SIMD scans
+std::vector<size_t> quickHullRange(const Point* pts, size_t lo, size_t hi)
+{
+    return quickHull(pts + lo, hi - lo);
+}
+
+template <class T>
+std::vector<size_t> quickHullRange(const Columns<T>& pts, size_t lo, size_t hi)
+{
+    return quickHull(pts.x + lo, pts.y + lo, hi - lo);
+}
+
+/*Hulls every group of m consecutive input points
+*
+* The first guess runs QuickHull on each group where it lies in the input,
+* which drops most points in SIMD passes instead of sorting all of them.
+* The groups of the previous guess tile the new ones, and a point that is
+* not on the hull of its small group is not on the hull of the bigger one
+* either, so later guesses only look at the previous hull vertices again,
+* few enough that a monotone chain over them is cheapest.
+*
+* @param prev: group hulls of the previous guess prevM, null for the first guess
+*/
+template <class Source>
+void buildGroups(const Source& pts, size_t n, size_t m, const GroupHulls* prev, size_t prevM, GroupHulls& groups)
+{
+    groups.verts.clear();
+    groups.points.clear();
+    groups.start.clear();
+    std::vector<Vertex> work;
+    std::vector<size_t> chain;
+    for (size_t lo = 0; lo < n; lo += m) {
+        const size_t hi = std::min(n, lo + m);
+        groups.start.push_back(groups.verts.size());
+        if (!prev) {
+            for (size_t i : quickHullRange(pts, lo, hi)) {
+                groups.verts.push_back(lo + i);
+                groups.points.push_back(pts[lo + i]);
+            }
+            continue;
+        }
+        work.clear();
+        const size_t from = prev->start[lo / prevM];
+        const size_t to = prev->start[(hi - 1) / prevM + 1];
+        for (size_t k = from; k < to; k++) {
+            work.push_back({ prev->points[k], prev->verts[k] });
+        }
+        groupHull(work, chain, groups);
+    }
+    groups.start.push_back(groups.verts.size());
+}
+
+//tangent by checking every vertex, points equal to p are skipped
+size_t tangentScan(const Point* v, size_t k, const Point& p)
+{
+    size_t best = k;
+    for (size_t i = 0; i < k; i++) {
+        if (v[i] != p && (best == k || betterTurn(p, v[best], v[i]))) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/*Position of the vertex of convex polygon v (counter-clockwise, k vertices)
+* that has the whole polygon left of p->v, k if none
+*
+* As p goes around the hull the tangent to a group only moves forward, so
+* the search first walks on from where the last one ended (hint). If that
+* does not land on a tangent, the angle to the vertices seen from p goes up
+* and then down once around the polygon, so the smallest one is found by
+* binary search relative to vertex 0. Anything that still does not check out
+* locally (p on the polygon, rounding) falls back to a scan.
+*/
+size_t tangent(const Point* v, size_t k, const Point& p, size_t& hint)
+{
+    if (k <= 4) {
+        return tangentScan(v, k, p);
+    }
+    auto at = [&](size_t i) -> const Point& { return v[i % k]; };
+    auto isTangent = [&](size_t i) {
+        return at(i) != p && orient2d(p, at(i), at(i + k - 1)) >= 0 && orient2d(p, at(i), at(i + 1)) >= 0;
+    };
+
+    size_t best = hint;
+    for (size_t steps = 0; steps < k && betterTurn(p, at(best), at(best + 1)); steps++) {
+        best = (best + 1) % k;
+    }
+    if (isTangent(best)) {
+        hint = best;
+        return best;
+    }
+
+    //angle to vertex i is below the angle to vertex j
+    auto below = [&](size_t i, size_t j) { return orient2d(p, at(j), at(i)) < 0; };
+    const bool down0 = below(1, 0);
+    size_t lo = 0, hi = k;
+    while (lo < hi) {
+        const size_t c = lo + (hi - lo) / 2;
+        const bool down = below(c + 1, c);
+        if (down0) {
+            //still going down from vertex 0, or already past the highest angle
+            if (!down || (c > 0 && !below(c, 0))) hi = c;
+            else lo = c + 1;
+        }
+        else {
+            if (down) lo = c + 1;
+            else if (below(c, 0)) hi = c;
+            else lo = c + 1;
+        }
+    }
+
+    best = lo % k;
+    const size_t prev = (best + k - 1) % k;
+    const size_t next = (best + 1) % k;
+    if (betterTurn(p, at(best), at(prev))) best = prev;
+    if (betterTurn(p, at(best), at(next))) best = next;
+    if (!isTangent(best)) {
+        best = tangentScan(v, k, p);
+    }
+    hint = best;
+    return best;
+}
+
+/*Gift wraps around the group hulls from start, at most limit steps
+*
+* @return false if the hull has more than limit vertices
+*/
+bool wrap(const Point& start, const GroupHulls& groups, size_t first, Cursor cur, size_t limit, std::vector<size_t>& hull)
+{
+    hull.assign(1, first);
+    const size_t count = groups.start.size() - 1;
+    std::vector<size_t> hints(count, 0);
+
+    for (size_t step = 0; step < limit; step++) {
+        const Point p = groups.points[groups.start[cur.group] + cur.pos];
+
+        bool found = false;
+        Cursor best = { 0, 0 };
+        Point bestPoint = p;
+        for (size_t g = 0; g < count; g++) {
+            const Point* v = groups.points.data() + groups.start[g];
+            const size_t k = groups.start[g + 1] - groups.start[g];
+            size_t pos;
+            if (g == cur.group) {
+                //p is a vertex of its own group, its successor there is the tangent
+                if (k == 1) {
+                    continue;
+                }
+                pos = (cur.pos + 1) % k;
+            }
+            else {
+                pos = tangent(v, k, p, hints[g]);
+                if (pos == k) {
+                    continue;
+                }
+            }
+            const Point& c = v[pos];
+            if (!found || betterTurn(p, bestPoint, c)) {
+                found = true;
+                best = { g, pos };
+                bestPoint = c;
+            }
+        }
+
+        if (!found || bestPoint == start) {
+            return true;
+        }
+        hull.push_back(groups.verts[groups.start[best.group] + best.pos]);
+        cur = best;
+    }
+    return false;
+}
+
+template <class Source>
+std::vector<size_t> chanHullOf(const Source& pts, size_t n)
+{
+    std::vector<size_t> hull;
+    if (n == 0) {
+        return hull;
+    }
+
+    size_t first = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (lessXY(pts[i], pts[first])) first = i;
+    }
+
+    GroupHulls groups, prev;
+    size_t prevM = 0;
+    //guesses m = 2^(2^t), squared after every miss so the total work stays
+    //O(n log h). Starts at 65536: QuickHull costs about the same per point
+    //on a group of any size, while every wrap step searches a tangent on
+    //every group, so fewer, bigger groups win until m is far above h.
+    for (unsigned t = 4;; t++) {
+        const unsigned bits = 1u << t;
+        const size_t m = bits >= 63 || ((size_t)1 << bits) >= n ? n : (size_t)1 << bits;
+        std::swap(groups, prev);
+        buildGroups(pts, n, m, prevM ? &prev : nullptr, prevM, groups);
+        prevM = m;
+
+        //the lowest point of the set is the first vertex of its group's hull
+        const size_t g = first / m;
+        if (wrap(pts[first], groups, first, { g, 0 }, m, hull)) {
+            return hull;
+        }
+    }
+}
+
+}
+
+std::vector<size_t> chanHull(const Point* pts, size_t n)
+{
+    return chanHullOf(pts, n);
+}
+
+std::vector<size_t> chanHull(const double* x, const double* y, size_t n)
+{
+    return chanHullOf(Columns<double>{ x, y }, n);
+}
+
+std::vector<size_t> chanHull(const float* x, const float* y, size_t n)
+{
+    return chanHullOf(Columns<float>{ x, y }, n);
+}
+
+}
@@ -0,0 +1,277 @@
+#include "dischull.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "hull.h"
+
+namespace geom {
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+const double twoPi = 2 * pi;
+
+//angle of v in [0, 2 pi)
+double angleOf(const Point& v)
+{
+    const double a = std::atan2(v.y, v.x);
+    return a < 0 ? a + twoPi : a;
+}
+
+double wrap(double a)
+{
+    a = std::fmod(a, twoPi);
+    return a < 0 ? a + twoPi : a;
+}
+
+//how far a reaches past b along angle t, > 0 where a is on the envelope
+double reachOver(const DiscArc& a, const DiscArc& b, double t)
+{
+    return (a.center.x - b.center.x) * std::cos(t) + (a.center.y - b.center.y) * std::sin(t) + a.radius - b.radius;
+}
+
+//appends the part of arc on [from, to], extending the last arc if it is on the same disc
+void append(std::vector<DiscArc>& out, const DiscArc& arc, double from, double to)
+{
+    if (to <= from) {
+        return;
+    }
+    if (!out.empty() && out.back().disc == arc.disc && out.back().to == from) {
+        out.back().to = to;
+        return;
+    }
+    DiscArc piece = arc;
+    piece.from = from;
+    piece.to = to;
+    out.push_back(piece);
+}
+
+/*Adds the envelope of a and b on [from, to] to out. reachOver() is
+* A cos t + B sin t + C, a sinusoid of amplitude hypot(A, B), so it changes
+* sign at most twice and where is a closed form. a wins ties, so of equal
+* discs the one with the lower index is kept.
+*/
+void mergeOn(std::vector<DiscArc>& out, const DiscArc& a, const DiscArc& b, double from, double to)
+{
+    const double A = a.center.x - b.center.x, B = a.center.y - b.center.y, C = a.radius - b.radius;
+    const double amplitude = std::hypot(A, B);
+
+    //one disc inside the other: reachOver() has the sign of C everywhere but
+    //where they touch, and the midpoint below can land right on that angle
+    if (!(std::fabs(C) < amplitude)) {
+        append(out, C >= 0 ? a : b, from, to);
+        return;
+    }
+
+    double cuts[4];
+    int count = 0;
+    cuts[count++] = from;
+    const double phase = std::atan2(B, A), spread = std::acos(-C / amplitude);
+    double r1 = wrap(phase - spread), r2 = wrap(phase + spread);
+    if (r2 < r1) {
+        std::swap(r1, r2);
+    }
+    for (double r : { r1, r2 }) {
+        if (r > from && r < to) {
+            cuts[count++] = r;
+        }
+    }
+    cuts[count++] = to;
+    for (int k = 0; k + 1 < count; k++) {
+        const double mid = 0.5 * (cuts[k] + cuts[k + 1]);
+        append(out, reachOver(a, b, mid) >= 0 ? a : b, cuts[k], cuts[k + 1]);
+    }
+}
+
+//upper envelope of two envelopes, walking the breakpoints of both
+std::vector<DiscArc> merge(const std::vector<DiscArc>& e1, const std::vector<DiscArc>& e2)
+{
+    std::vector<DiscArc> out;
+    out.reserve(2 * (e1.size() + e2.size()));
+    size_t i = 0, j = 0;
+    double from = 0;
+    while (i < e1.size() && j < e2.size()) {
+        const double to = (std::min)(e1[i].to, e2[j].to);
+        mergeOn(out, e1[i], e2[j], from, to);
+        from = to;
+        if (e1[i].to == to) {
+            i++;
+        }
+        if (e2[j].to == to) {
+            j++;
+        }
+    }
+    return out;
+}
+
+std::vector<DiscArc> envelopeOf(const Disc* discs, size_t first, size_t last)
+{
+    if (last - first == 1) {
+        return { { discs[first].center, discs[first].radius, 0, twoPi, first } };
+    }
+    const size_t mid = first + (last - first) / 2;
+    return merge(envelopeOf(discs, first, mid), envelopeOf(discs, mid, last));
+}
+
+/*Indices of the discs that can be on the hull, ascending, as aklToussaint()
+* does for points: the discs furthest out in 8 directions are on the hull,
+* so is the polygon of their centers, and a disc inside that polygon can't
+* reach past the hull anywhere
+*/
+std::vector<size_t> survivors(const Disc* discs, size_t n)
+{
+    const double s = std::sqrt(0.5);
+    const Point directions[8] = { { 1, 0 }, { s, s }, { 0, 1 }, { -s, s }, { -1, 0 }, { -s, -s }, { 0, -1 }, { s, -s } };
+    Point corners[8];
+    for (int k = 0; k < 8; k++) {
+        size_t best = 0;
+        for (size_t i = 1; i < n; i++) {
+            if (dot(discs[i].center, directions[k]) + discs[i].radius > dot(discs[best].center, directions[k]) + discs[best].radius) {
+                best = i;
+            }
+        }
+        corners[k] = discs[best].center;
+    }
+    const std::vector<size_t> ring = quickHull(corners, 8);
+
+    //inward unit normals and offsets of the polygon's edges
+    std::vector<Point> normal;
+    std::vector<double> offset;
+    for (size_t k = 0; k < ring.size() && ring.size() >= 3; k++) {
+        const Point& p = corners[ring[k]];
+        const Point e = corners[ring[(k + 1) % ring.size()]] - p;
+        const double len = std::sqrt(dot(e, e));
+        normal.push_back({ -e.y / len, e.x / len });
+        offset.push_back(dot(normal.back(), p));
+    }
+
+    std::vector<size_t> keep;
+    for (size_t i = 0; i < n; i++) {
+        bool inside = !normal.empty();
+        for (size_t k = 0; k < normal.size() && inside; k++) {
+            inside = dot(normal[k], discs[i].center) - offset[k] > discs[i].radius;
+        }
+        if (!inside) {
+            keep.push_back(i);
+        }
+    }
+    return keep;
+}
+
+}
+
+DiscHull::DiscHull()
+{
+}
+
+DiscHull::DiscHull(std::vector<DiscArc> arcs) : pieces(std::move(arcs))
+{
+}
+
+DiscHull::DiscHull(const Disc* discs, size_t n)
+{
+    build(discs, n);
+}
+
+void DiscHull::build(const Disc* discs, size_t n)
+{
+    pieces.clear();
+    if (n == 0) {
+        return;
+    }
+    const std::vector<size_t> keep = survivors(discs, n);
+    std::vector<Disc> kept(keep.size());
+    for (size_t i = 0; i < keep.size(); i++) {
+        kept[i] = discs[keep[i]];
+    }
+    pieces = envelopeOf(kept.data(), 0, kept.size());
+    for (DiscArc& arc : pieces) {
+        arc.disc = keep[arc.disc];
+    }
+}
+
+DiscHull DiscHull::rounded(const Point* pts, size_t n, double radius)
+{
+    std::vector<DiscArc> arcs;
+    if (n == 0) {
+        return DiscHull(arcs);
+    }
+    if (n == 1) {
+        arcs.push_back({ pts[0], radius, 0, twoPi, 0 });
+        return DiscHull(arcs);
+    }
+
+    //vertex k is on the hull from the normal of the edge into it to the normal
+    //of the edge out of it, start at the vertex whose normals pass angle 0
+    std::vector<double> normal(n);
+    size_t first = 0;
+    for (size_t k = 0; k < n; k++) {
+        const Point e = pts[k + 1 == n ? 0 : k + 1] - pts[k];
+        normal[k] = angleOf({ e.y, -e.x });
+        if (normal[k] < normal[first]) {
+            first = k;
+        }
+    }
+    arcs.reserve(n + 1);
+    arcs.push_back({ pts[first], radius, 0, normal[first], first });
+    for (size_t i = 1; i < n; i++) {
+        const size_t k = (first + i) % n;
+        const size_t before = k == 0 ? n - 1 : k - 1;
+        arcs.push_back({ pts[k], radius, normal[before], normal[k], k });
+    }
+    const size_t last = first == 0 ? n - 1 : first - 1;
+    arcs.push_back({ pts[first], radius, normal[last], twoPi, first });
+    arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [](const DiscArc& a) { return a.to <= a.from; }), arcs.end());
+    return DiscHull(arcs);
+}
+
+size_t DiscHull::extreme(const Point& d) const
+{
+    const double t = angleOf(d);
+    size_t lo = 0, hi = pieces.size() - 1;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (pieces[mid].to <= t) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+Point DiscHull::support(const Point& d) const
+{
+    const DiscArc& arc = pieces[extreme(d)];
+    const double len = std::sqrt(dot(d, d));
+    if (len == 0) {
+        return arc.center;
+    }
+    return arc.center + (arc.radius / len) * d;
+}
+
+std::vector<Point> DiscHull::outline(double tolerance) const
+{
+    std::vector<Point> out;
+    for (const DiscArc& arc : pieces) {
+        //chords of this angle stay within tolerance of the circle
+        const double step = arc.radius > tolerance ? 2 * std::acos(1 - tolerance / arc.radius) : twoPi;
+        const size_t steps = (size_t)std::ceil((arc.to - arc.from) / step);
+        for (size_t s = 0; s <= steps; s++) {
+            //2 pi is computed as 0, so the arc through angle 0 joins up exactly
+            const double t = s < steps ? arc.from + s * (arc.to - arc.from) / steps : arc.to < twoPi ? arc.to : 0;
+            const Point p = { arc.center.x + arc.radius * std::cos(t), arc.center.y + arc.radius * std::sin(t) };
+            if (out.empty() || p != out.back()) {
+                out.push_back(p);
+            }
+        }
+    }
+    if (out.size() > 1 && out.front() == out.back()) {
+        out.pop_back();
+    }
+    return out;
+}
+
+}
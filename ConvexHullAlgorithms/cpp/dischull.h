@@ -0,0 +1,92 @@
+#ifndef _DISCHULL_H
+#define _DISCHULL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+struct Disc
+{
+    Point  center;
+    double radius;
+};
+
+/*One arc of a DiscHull's boundary
+*
+* The arc is on its disc where the outward normal turns from angle from to
+* angle to. Consecutive arcs are joined by the segment from one's end to the
+* next one's start, which is tangent to both discs.
+*/
+struct DiscArc
+{
+    Point  center;
+    double radius;
+    double from;    //outward normal angles, 0 <= from < to <= 2 pi
+    double to;
+    size_t disc;    //index into what it was built from, see DiscHull::build() and rounded()
+};
+
+/*Convex hull of discs, as arcs of the discs on it joined by bitangents
+*
+* Every disc has a support function, how far it reaches along a direction,
+* and the hull's is their upper envelope. Two discs' support functions
+* cross at most twice around the circle, so the envelope has at most 2n - 1
+* arcs, and two envelopes merge in time linear in their arcs. Dividing the
+* discs in halves and merging their envelopes builds the hull in O(n log n),
+* with no sampling of the circles into points.
+*
+* The same arcs describe any rounded convex shape. A polygon is a hull of
+* discs of radius 0 and a rounded polygon one of equal radii, see rounded().
+* A support query is a binary search over the arcs, so gjk() and epa() on
+* rounded shapes cost O(log h) per step like they do on a SupportMap, and
+* minkowskiSum() of two of them merges arcs like it merges edges.
+*/
+class DiscHull
+{
+public:
+    DiscHull();
+
+    //arcs as arcs() returns them, from 0 to 2 pi
+    explicit DiscHull(std::vector<DiscArc> arcs);
+
+    /*@param discs: any order, duplicates and discs inside others are fine,
+    *              a radius of 0 is a point
+    */
+    DiscHull(const Disc* discs, size_t n);
+    void build(const Disc* discs, size_t n);
+
+    /*A convex polygon grown by radius, with disc the vertex each arc is on
+    *
+    * @param pts: counter-clockwise with no collinear vertices, as quickHull() returns them
+    */
+    static DiscHull rounded(const Point* pts, size_t n, double radius);
+
+    /*The boundary counter-clockwise from the rightmost point. Adjacent arcs
+    * are on different discs, except that the arc through angle 0 is split
+    * into the first and the last.
+    */
+    const std::vector<DiscArc>& arcs() const { return pieces; }
+    size_t                      size() const { return pieces.size(); }
+    bool                        empty() const { return pieces.empty(); }
+
+    //index of the arc whose normals include d, the hull must not be empty
+    size_t extreme(const Point& d) const;
+
+    //point of the hull furthest along d, the center of that arc when d is 0
+    Point support(const Point& d) const;
+
+    /*The boundary as a counter-clockwise polygon for drawing, no point of
+    * the hull more than tolerance outside it
+    */
+    std::vector<Point> outline(double tolerance) const;
+
+private:
+    std::vector<DiscArc> pieces;
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef _DISPATCH_H
+#define _DISPATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+#include "hull.h"
+#include "prefilter.h"
+
+namespace geom {
+
+/*Hull algorithms as policy types
+*
+* convexHull<Algorithm>(pts, n) picks the engine for the algorithm, the
+* coordinate type and the layout (a PointT array or Columns) at compile
+* time. The call inlines to a direct call into that engine, and asking for
+* a combination the engine does not have is a compile error instead of a
+* branch at run time.
+*
+* hullFunction<Algorithm>() is the Point array version behind a plain
+* function pointer, for code that is handed its engine: KineticHull's full
+* rebuilds, and in the app each graph algorithm that hulls the graph's own
+* points (GraphAlgorithm in main.cpp) carries one.
+*/
+
+struct QuickHull
+{
+    template <class T>
+    static std::vector<size_t> hull(const PointT<T>* pts, size_t n) { return quickHull(pts, n); }
+
+    template <class T>
+    static std::vector<size_t> hull(const Columns<T>& pts, size_t n) { return quickHull(pts.x, pts.y, n); }
+};
+
+//doubles in a Point array only
+struct ParallelQuickHull
+{
+    static std::vector<size_t> hull(const Point* pts, size_t n) { return quickHullParallel(pts, n); }
+};
+
+struct ChanHull
+{
+    static std::vector<size_t> hull(const Point* pts, size_t n) { return chanHull(pts, n); }
+
+    template <class T>
+    static std::vector<size_t> hull(const Columns<T>& pts, size_t n) { return chanHull(pts.x, pts.y, n); }
+};
+
+//Algorithm behind the Akl-Toussaint filter, see filteredHull()
+template <class Algorithm>
+struct Filtered
+{
+    static std::vector<size_t> hull(const Point* pts, size_t n)
+    {
+        return filteredHull(pts, n, [](const Point* p, size_t m) { return Algorithm::hull(p, m); });
+    }
+};
+
+/*Hull of pts with Algorithm
+*
+* @param pts: a PointT array or Columns
+*
+* @return indices into pts, as quickHull() returns them
+*/
+template <class Algorithm, class Source>
+inline std::vector<size_t> convexHull(const Source& pts, size_t n)
+{
+    return Algorithm::hull(pts, n);
+}
+
+template <class Algorithm>
+inline HullFunction hullFunction()
+{
+    return &Algorithm::hull;
+}
+
+}
+
+#endif
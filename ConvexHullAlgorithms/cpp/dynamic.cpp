@@ -0,0 +1,490 @@
+#include "dynamic.h"
+
+#include <algorithm>
+
+#include "predicates.h"
+
+namespace geom {
+
+/*Sides: 0 is the upper hull, walked in lexicographic order. 1 is the lower
+* hull, walked in reverse, which is the upper hull of the points turned by
+* 180 degrees. Turning keeps every orientation, so both sides share one
+* bridge search with the children swapped.
+*/
+namespace {
+
+template <class N>
+N* firstChild(N* v, int side) { return side == 0 ? v->left : v->right; }
+
+template <class N>
+N* secondChild(N* v, int side) { return side == 0 ? v->right : v->left; }
+
+template <class N>
+bool isLeaf(const N* v) { return v->left == nullptr; }
+
+//whether leaf is below v's first child on the side
+template <class N>
+bool inFirstChild(const N* v, int side, const N* leaf)
+{
+    return side == 0 ? !lessXY(v->left->hi->p, leaf->p) : !lessXY(leaf->p, v->right->lo->p);
+}
+
+//by y, then by x
+inline bool lessYX(const Point& a, const Point& b)
+{
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+}
+
+DynamicHull::DynamicHull() : root(nullptr), count(0), seed(0x9e3779b97f4a7c15ull)
+{
+}
+
+DynamicHull::~DynamicHull()
+{
+}
+
+uint32_t DynamicHull::nextPriority()
+{
+    //splitmix64
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return (uint32_t)((z ^ (z >> 31)) >> 32) | 1;
+}
+
+DynamicHull::Node* DynamicHull::allocate()
+{
+    if (!freeNodes.empty()) {
+        Node* v = freeNodes.back();
+        freeNodes.pop_back();
+        return v;
+    }
+    nodes.emplace_back();
+    return &nodes.back();
+}
+
+DynamicHull::Node* DynamicHull::newLeaf(const Point& p, size_t id)
+{
+    Node* v = allocate();
+    v->left = v->right = nullptr;
+    v->lo = v->hi = v;
+    v->bottom = v->top = v;
+    v->bridge[0] = v->bridge[1] = { v, v };
+    v->chainSize[0] = v->chainSize[1] = 1;
+    v->before[0] = v->before[1] = 0;
+    v->skipped[0] = v->skipped[1] = 0;
+    v->priority = 0;
+    v->p = p;
+    v->ids.assign(1, id);
+    return v;
+}
+
+//left and right are not pulled into it, see pull()
+DynamicHull::Node* DynamicHull::newInner(Node* left, Node* right)
+{
+    Node* v = allocate();
+    v->left = left;
+    v->right = right;
+    v->priority = nextPriority();
+    v->ids.clear();
+    return v;
+}
+
+void DynamicHull::release(Node* v)
+{
+    v->ids.clear();
+    freeNodes.push_back(v);
+}
+
+void DynamicHull::clear()
+{
+    root = nullptr;
+    count = 0;
+    nodes.clear();
+    freeNodes.clear();
+}
+
+/*The upper (side 0) or lower (side 1) bridge between v's children
+*
+* x walks the child whose points come first on the side and y the other
+* one. While either is an inner node, its bridge a->b (c->d for y) splits
+* its hull, and one of the four halves is shown to hold no bridge end:
+*   - c strictly above the line ab: the end in x is a or before it
+*   - b strictly above the line cd: the end in y is d or after it
+*   - otherwise the lines ab and cd cross, and where they cross relative
+*     to the last point s before the split decides which of b's or c's
+*     outer half is dropped
+* A leaf only has a point, which settles the other side's test alone.
+* Points on the bridge line are tied to whichever end the tests keep, so
+* each end is then moved out to its chain neighbour if that is on the line
+* too. The chains only ever hold strict vertices, so there is at most one
+* such neighbour per end and the counts in pull() need no correction.
+*
+* fromRank and toRank are set to the ends' positions on their children's
+* chains, counted from 1.
+*/
+DynamicHull::Bridge DynamicHull::findBridge(const Node* v, int side, size_t& fromRank, size_t& toRank) const
+{
+    const Node* x = firstChild(v, side);
+    const Node* y = secondChild(v, side);
+    const Point& s = side == 0 ? v->left->hi->p : v->right->lo->p;
+    const int after = side == 0 ? 1 : -1;
+
+    while (!isLeaf(x) || !isLeaf(y)) {
+        const Point& a = x->bridge[side].from->p;
+        const Point& b = x->bridge[side].to->p;
+        const Point& c = y->bridge[side].from->p;
+        const Point& d = y->bridge[side].to->p;
+        if (!isLeaf(x) && orient2d(a, b, c) > 0) {
+            x = firstChild(x, side);
+        }
+        else if (!isLeaf(y) && orient2d(c, d, b) > 0) {
+            y = secondChild(y, side);
+        }
+        else if (isLeaf(x)) {
+            y = firstChild(y, side);
+        }
+        else if (isLeaf(y)) {
+            x = secondChild(x, side);
+        }
+        else if (compareIntersection(a, b, c, d, s) * after > 0) {
+            y = firstChild(y, side);
+        }
+        else {
+            x = secondChild(x, side);
+        }
+    }
+
+    size_t xRank, yRank;
+    const Node* outer = previous(firstChild(v, side), side, x, xRank);
+    if (outer && orient2d(outer->p, x->p, y->p) == 0) {
+        x = outer;
+        xRank--;
+    }
+    outer = next(secondChild(v, side), side, y, yRank);
+    if (outer && orient2d(x->p, y->p, outer->p) == 0) {
+        y = outer;
+        yRank++;
+    }
+    fromRank = xRank;
+    toRank = yRank;
+    return { x, y };
+}
+
+/*The leaf before leaf on v's chain, which it must be on, nullptr for the
+* first one. rank is set to leaf's position on the chain, counted from 1.
+*/
+const DynamicHull::Node* DynamicHull::previous(const Node* v, int side, const Node* leaf, size_t& rank) const
+{
+    size_t r = 0;
+    while (!isLeaf(v)) {
+        if (inFirstChild(v, side, leaf)) {
+            v = firstChild(v, side);
+        }
+        else if (leaf == v->bridge[side].to) {
+            rank = r + v->before[side] + 1;
+            return v->bridge[side].from;
+        }
+        else {
+            r += v->before[side];
+            r -= v->skipped[side];
+            v = secondChild(v, side);
+        }
+    }
+    rank = r + 1;
+    return nullptr;
+}
+
+//the leaf after leaf on v's chain, nullptr for the last one, rank as for previous()
+const DynamicHull::Node* DynamicHull::next(const Node* v, int side, const Node* leaf, size_t& rank) const
+{
+    size_t r = 0;
+    while (!isLeaf(v)) {
+        if (!inFirstChild(v, side, leaf)) {
+            r += v->before[side];
+            r -= v->skipped[side];
+            v = secondChild(v, side);
+        }
+        else if (leaf == v->bridge[side].from) {
+            rank = r + v->before[side];
+            return v->bridge[side].to;
+        }
+        else {
+            v = firstChild(v, side);
+        }
+    }
+    rank = r + 1;
+    return nullptr;
+}
+
+//recomputes v from its children, O(log n)
+void DynamicHull::pull(Node* v)
+{
+    v->lo = v->left->lo;
+    v->hi = v->right->hi;
+    v->bottom = lessYX(v->right->bottom->p, v->left->bottom->p) ? v->right->bottom : v->left->bottom;
+    v->top = lessYX(v->right->top->p, v->left->top->p) ? v->left->top : v->right->top;
+    for (int side = 0; side < 2; side++) {
+        size_t fromRank, toRank;
+        v->bridge[side] = findBridge(v, side, fromRank, toRank);
+        v->before[side] = (uint32_t)fromRank;
+        v->skipped[side] = (uint32_t)toRank - 1;
+        v->chainSize[side] = v->before[side] + secondChild(v, side)->chainSize[side] - v->skipped[side];
+    }
+}
+
+void DynamicHull::pullTree(Node* v)
+{
+    if (isLeaf(v)) {
+        return;
+    }
+    pullTree(v->left);
+    pullTree(v->right);
+    pull(v);
+}
+
+void DynamicHull::build(const Point* pts, size_t n)
+{
+    std::vector<size_t> ids(n);
+    for (size_t i = 0; i < n; i++) {
+        ids[i] = i;
+    }
+    build(pts, ids.data(), n);
+}
+
+void DynamicHull::build(const Point* pts, const size_t* ids, size_t n)
+{
+    clear();
+    count = n;
+    if (n == 0) {
+        return;
+    }
+
+    //stable, so the copies of a point keep their order
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t i, size_t j) { return lessXY(pts[i], pts[j]); });
+    std::vector<Node*> leaves;
+    for (size_t i : order) {
+        if (!leaves.empty() && leaves.back()->p == pts[i]) {
+            leaves.back()->ids.push_back(ids[i]);
+        }
+        else {
+            leaves.push_back(newLeaf(pts[i], ids[i]));
+        }
+    }
+
+    /*One inner node per gap between neighbouring leaves, arranged as the
+    * Cartesian tree of their priorities, which is the treap inserting them
+    * one by one would give. Children missing after that are the leaves on
+    * either side of the gap.
+    */
+    const size_t gaps = leaves.size() - 1;
+    std::vector<Node*> inner(gaps);
+    std::vector<Node*> spine;
+    for (size_t i = 0; i < gaps; i++) {
+        Node* g = newInner(nullptr, nullptr);
+        Node* last = nullptr;
+        while (!spine.empty() && spine.back()->priority < g->priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        g->left = last;
+        if (!spine.empty()) {
+            spine.back()->right = g;
+        }
+        spine.push_back(g);
+        inner[i] = g;
+    }
+    for (size_t i = 0; i < gaps; i++) {
+        if (!inner[i]->left) inner[i]->left = leaves[i];
+        if (!inner[i]->right) inner[i]->right = leaves[i + 1];
+    }
+    root = gaps == 0 ? leaves[0] : spine.front();
+    pullTree(root);
+}
+
+DynamicHull::Node* DynamicHull::insertAt(Node* v, Node* leaf)
+{
+    if (isLeaf(v)) {
+        if (v->p == leaf->p) {
+            v->ids.push_back(leaf->ids[0]);
+            release(leaf);
+            return v;
+        }
+        Node* n = lessXY(leaf->p, v->p) ? newInner(leaf, v) : newInner(v, leaf);
+        pull(n);
+        return n;
+    }
+
+    //the new node rotates up past any parent of lower priority
+    if (!lessXY(v->left->hi->p, leaf->p)) {
+        v->left = insertAt(v->left, leaf);
+        if (v->left->priority > v->priority) {
+            Node* l = v->left;
+            v->left = l->right;
+            l->right = v;
+            pull(v);
+            v = l;
+        }
+    }
+    else {
+        v->right = insertAt(v->right, leaf);
+        if (v->right->priority > v->priority) {
+            Node* r = v->right;
+            v->right = r->left;
+            r->left = v;
+            pull(v);
+            v = r;
+        }
+    }
+    pull(v);
+    return v;
+}
+
+void DynamicHull::insert(const Point& p, size_t id)
+{
+    Node* leaf = newLeaf(p, id);
+    root = root ? insertAt(root, leaf) : leaf;
+    count++;
+}
+
+/*Takes id off the leaf at p below v. A leaf left with no ids is removed
+* together with its parent, whose other child takes the parent's place.
+*/
+DynamicHull::Node* DynamicHull::eraseAt(Node* v, const Point& p, size_t id, bool& found)
+{
+    if (isLeaf(v)) {
+        if (v->p == p) {
+            std::vector<size_t>::iterator it = std::find(v->ids.begin(), v->ids.end(), id);
+            if (it != v->ids.end()) {
+                v->ids.erase(it);
+                found = true;
+            }
+        }
+        if (v->ids.empty()) {
+            release(v);
+            return nullptr;
+        }
+        return v;
+    }
+
+    const bool inLeft = !lessXY(v->left->hi->p, p);
+    Node*& child = inLeft ? v->left : v->right;
+    child = eraseAt(child, p, id, found);
+    if (!child) {
+        Node* other = inLeft ? v->right : v->left;
+        release(v);
+        return other;
+    }
+    if (found) {
+        pull(v);
+    }
+    return v;
+}
+
+bool DynamicHull::erase(const Point& p, size_t id)
+{
+    if (!root) {
+        return false;
+    }
+    bool found = false;
+    root = eraseAt(root, p, id, found);
+    if (found) {
+        count--;
+    }
+    return found;
+}
+
+bool DynamicHull::move(const Point& from, const Point& to, size_t id)
+{
+    if (!erase(from, id)) {
+        return false;
+    }
+    insert(to, id);
+    return true;
+}
+
+/*Appends the leaves of v's hull on one side from leaf from to leaf to,
+* both on it and from first in the side's order
+*/
+void DynamicHull::chain(const Node* v, int side, const Node* from, const Node* to, std::vector<const Node*>& out) const
+{
+    if (isLeaf(v)) {
+        out.push_back(v);
+        return;
+    }
+    const Node* first = firstChild(v, side);
+    const Node* second = secondChild(v, side);
+    if (inFirstChild(v, side, to)) {
+        chain(first, side, from, to, out);
+    }
+    else if (!inFirstChild(v, side, from)) {
+        chain(second, side, from, to, out);
+    }
+    else {
+        chain(first, side, from, v->bridge[side].from, out);
+        chain(second, side, v->bridge[side].to, to, out);
+    }
+}
+
+std::vector<const DynamicHull::Node*> DynamicHull::hullLeaves() const
+{
+    std::vector<const Node*> hull;
+    if (!root) {
+        return hull;
+    }
+    if (isLeaf(root)) {
+        hull.push_back(root);
+        return hull;
+    }
+
+    //lower hull left to right, then upper hull right to left, the chains
+    //only hold strict vertices, see findBridge()
+    std::vector<const Node*> upper;
+    chain(root, 0, root->lo, root->hi, upper);
+    chain(root, 1, root->hi, root->lo, hull);
+    std::reverse(hull.begin(), hull.end());
+    hull.insert(hull.end(), upper.rbegin() + 1, upper.rend() - 1);
+
+    return hull;
+}
+
+/*Both chains run from the lowest to the highest leaf and hold only strict
+* vertices, so the hull is both of them without the shared ends, which for
+* collinear points leaves just those two
+*/
+size_t DynamicHull::hullSize() const
+{
+    if (!root) {
+        return 0;
+    }
+    if (isLeaf(root)) {
+        return 1;
+    }
+    return root->chainSize[0] + root->chainSize[1] - 2;
+}
+
+std::vector<size_t> DynamicHull::vertices() const
+{
+    std::vector<size_t> ids;
+    for (const Node* v : hullLeaves()) {
+        ids.push_back(v->ids.front());
+    }
+    return ids;
+}
+
+std::vector<Point> DynamicHull::vertexPoints() const
+{
+    std::vector<Point> pts;
+    for (const Node* v : hullLeaves()) {
+        pts.push_back(v->p);
+    }
+    return pts;
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef _DYNAMIC_H
+#define _DYNAMIC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+/*Convex hull under insertions and deletions, O(log^2 n) per update
+*
+* The points sit in the leaves of a treap in lexicographic order. Every
+* inner node keeps the bridges between its two children, the edges of the
+* upper and lower hull of its subtree that cross from one child to the
+* other. A bridge is found in one simultaneous descent of both children
+* (Overmars and van Leeuwen's case analysis, with the ties broken
+* lexicographically and every test exact), so an update costs O(log n) per
+* node on its path. The hull is never stored, vertices() walks it down the
+* bridges in O(h log n). Each node also counts the vertices on its two
+* chains and keeps its extreme leaves, so the hull size and the extreme
+* points in x and y are O(1).
+*
+* Every point carries an id chosen by the caller. Points at the same
+* position share a leaf and the hull reports the oldest id still there.
+*/
+class DynamicHull
+{
+public:
+    DynamicHull();
+    ~DynamicHull();
+
+    DynamicHull(const DynamicHull&) = delete;
+    DynamicHull& operator=(const DynamicHull&) = delete;
+
+    //replaces the contents with pts, O(n log n), ids are 0..n-1 unless given
+    void build(const Point* pts, size_t n);
+    void build(const Point* pts, const size_t* ids, size_t n);
+
+    void insert(const Point& p, size_t id);
+
+    //returns false if no point with that id is at p
+    bool erase(const Point& p, size_t id);
+
+    //erase(from, id) then insert(to, id)
+    bool move(const Point& from, const Point& to, size_t id);
+
+    void clear();
+
+    //number of points, copies included
+    size_t size() const { return count; }
+    bool   empty() const { return count == 0; }
+
+    //number of hull vertices, as vertices() would return them
+    size_t hullSize() const;
+
+    //extreme hull vertices, the hull must not be empty: lowest x then lowest
+    //y, highest x then highest y, lowest y then lowest x, highest y then highest x
+    const Point& leftmost() const { return root->lo->p; }
+    const Point& rightmost() const { return root->hi->p; }
+    const Point& bottom() const { return root->bottom->p; }
+    const Point& top() const { return root->top->p; }
+
+    //ids of the hull vertices counter-clockwise from the lowest-x (then
+    //lowest-y) point, as quickHull() orders them, with no collinear vertices
+    std::vector<size_t> vertices() const;
+    std::vector<Point>  vertexPoints() const;
+
+private:
+    struct Node;
+
+    //a hull edge from one child's points to the other's, in the order the side walks them
+    struct Bridge
+    {
+        const Node* from;
+        const Node* to;
+    };
+
+    //a leaf is one position, an inner node has both children and the bridges between them
+    struct Node
+    {
+        Node*               left;
+        Node*               right;
+        const Node*         lo;          //first and last leaf below, lexicographically
+        const Node*         hi;
+        const Node*         bottom;      //lowest and highest leaf below, by y then x
+        const Node*         top;
+        Bridge              bridge[2];   //upper, lower; a leaf's are itself
+        uint32_t            chainSize[2];//leaves on the upper and lower chain
+        uint32_t            before[2];   //of those, how many come from the first child
+        uint32_t            skipped[2];  //leaves of the second child's chain left out
+        uint32_t            priority;    //treap heap order, 0 for leaves
+        Point               p;           //leaf only
+        std::vector<size_t> ids;         //leaf only, oldest first
+    };
+
+    Node* allocate();
+    Node* newLeaf(const Point& p, size_t id);
+    Node* newInner(Node* left, Node* right);
+    void  release(Node* v);
+    void  pull(Node* v);
+    void  pullTree(Node* v);
+    Bridge findBridge(const Node* v, int side, size_t& fromRank, size_t& toRank) const;
+
+    const Node* previous(const Node* v, int side, const Node* leaf, size_t& rank) const;
+    const Node* next(const Node* v, int side, const Node* leaf, size_t& rank) const;
+
+    Node* insertAt(Node* v, Node* leaf);
+    Node* eraseAt(Node* v, const Point& p, size_t id, bool& found);
+
+    void chain(const Node* v, int side, const Node* from, const Node* to, std::vector<const Node*>& out) const;
+    std::vector<const Node*> hullLeaves() const;
+
+    uint32_t nextPriority();
+
+    Node*              root;
+    size_t             count;
+    uint64_t           seed;
+    std::deque<Node>   nodes;
+    std::vector<Node*> freeNodes;
+};
+
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef _EXACT_H
+#define _EXACT_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "geometry.h"
+#include "predicates.h"
+
+namespace geom {
+
+/*Signed 128-bit integer, wide enough for any product of two int64 values
+*
+* The compiler's own type where there is one. MSVC has none, so there it is
+* a pair of words with the few operations the predicates need, multiplying
+* through _mul128 on x64 and 32-bit halves elsewhere.
+*/
+#if defined(__SIZEOF_INT128__)
+
+typedef __int128 Int128;
+
+inline Int128 mul(int64_t a, int64_t b) { return (Int128)a * b; }
+
+#else
+
+struct Int128
+{
+    uint64_t lo;
+    int64_t  hi;
+};
+
+inline Int128 operator+(const Int128& a, const Int128& b)
+{
+    const uint64_t lo = a.lo + b.lo;
+    return { lo, (int64_t)((uint64_t)a.hi + (uint64_t)b.hi + (lo < a.lo)) };
+}
+
+inline Int128 operator-(const Int128& a, const Int128& b)
+{
+    return { a.lo - b.lo, (int64_t)((uint64_t)a.hi - (uint64_t)b.hi - (a.lo < b.lo)) };
+}
+
+inline bool operator<(const Int128& a, const Int128& b) { return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo); }
+inline bool operator>(const Int128& a, const Int128& b) { return b < a; }
+inline bool operator==(const Int128& a, const Int128& b) { return a.hi == b.hi && a.lo == b.lo; }
+
+inline Int128 mul(int64_t a, int64_t b)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    Int128 r;
+    r.lo = (uint64_t)_mul128(a, b, &r.hi);
+    return r;
+#else
+    //magnitudes multiplied in 32-bit halves, then the sign put back
+    const uint64_t ua = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+    const uint64_t ub = b < 0 ? 0 - (uint64_t)b : (uint64_t)b;
+    const uint64_t a0 = ua & 0xffffffff, a1 = ua >> 32;
+    const uint64_t b0 = ub & 0xffffffff, b1 = ub >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+    uint64_t lo = (mid << 32) | (p00 & 0xffffffff);
+    uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    if ((a < 0) != (b < 0)) {
+        lo = ~lo + 1;
+        hi = ~hi + (lo == 0);
+    }
+    return { lo, (int64_t)hi };
+#endif
+}
+
+#endif
+
+/*The arithmetic the templated engines do on each coordinate type
+*
+* Area holds twice a signed triangle area. For int32 coordinates the
+* differences are taken in int64 and multiplied into Int128, so every
+* orientation, distance and angle comparison is exact with no filter. Float
+* and double coordinates go through orient2d() for an exact sign, but their
+* distances are rounded, which the engines make up for afterwards.
+*/
+template <class T>
+struct Exact;
+
+template <>
+struct Exact<int32_t>
+{
+    typedef Int128 Area;
+
+    static const bool exact = true;
+
+    //twice the signed area of abc, > 0 when c is left of a->b
+    static Area orient(const IntPoint& a, const IntPoint& b, const IntPoint& c)
+    {
+        return mul((int64_t)b.x - a.x, (int64_t)c.y - a.y) - mul((int64_t)b.y - a.y, (int64_t)c.x - a.x);
+    }
+
+    //dot(b - a, p), orders points along a->b
+    static Area along(const IntPoint& a, const IntPoint& b, const IntPoint& p)
+    {
+        return mul((int64_t)b.x - a.x, p.x) + mul((int64_t)b.y - a.y, p.y);
+    }
+
+    //cross(a1 - a0, b1 - b0), > 0 when edge b turns left of edge a
+    static Area turn(const IntPoint& a0, const IntPoint& a1, const IntPoint& b0, const IntPoint& b1)
+    {
+        return mul((int64_t)a1.x - a0.x, (int64_t)b1.y - b0.y) - mul((int64_t)a1.y - a0.y, (int64_t)b1.x - b0.x);
+    }
+
+    static int side(const IntPoint& a, const IntPoint& b, const IntPoint& c)
+    {
+        const Area o = orient(a, b, c);
+        return Area() < o ? 1 : o < Area() ? -1 : 0;
+    }
+};
+
+template <>
+struct Exact<double>
+{
+    typedef double Area;
+
+    static const bool exact = false;
+
+    static Area orient(const Point& a, const Point& b, const Point& c) { return orient2d(a, b, c); }
+    static Area along(const Point& a, const Point& b, const Point& p) { return dot(b - a, p); }
+    static Area turn(const Point& a0, const Point& a1, const Point& b0, const Point& b1) { return cross(a1 - a0, b1 - b0); }
+
+    static int side(const Point& a, const Point& b, const Point& c)
+    {
+        const double o = orient2d(a, b, c);
+        return o > 0 ? 1 : o < 0 ? -1 : 0;
+    }
+};
+
+//floats widen to double exactly, so they share its arithmetic
+template <>
+struct Exact<float>
+{
+    typedef double Area;
+
+    static const bool exact = false;
+
+    static Point wide(const FloatPoint& p) { return { p.x, p.y }; }
+
+    static Area orient(const FloatPoint& a, const FloatPoint& b, const FloatPoint& c)
+    {
+        return Exact<double>::orient(wide(a), wide(b), wide(c));
+    }
+    static Area along(const FloatPoint& a, const FloatPoint& b, const FloatPoint& p)
+    {
+        return Exact<double>::along(wide(a), wide(b), wide(p));
+    }
+    static Area turn(const FloatPoint& a0, const FloatPoint& a1, const FloatPoint& b0, const FloatPoint& b1)
+    {
+        return Exact<double>::turn(wide(a0), wide(a1), wide(b0), wide(b1));
+    }
+    static int side(const FloatPoint& a, const FloatPoint& b, const FloatPoint& c)
+    {
+        return Exact<double>::side(wide(a), wide(b), wide(c));
+    }
+};
+
+}
+
+#endif
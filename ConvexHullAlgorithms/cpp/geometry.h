@@ -0,0 +1,70 @@
+#ifndef _GEOMETRY_H
+#define _GEOMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*Headless geometry types shared by the hull engines.
+*
+* Nothing in here depends on Win32 or Direct2D so the same code can be
+* built and benchmarked on Linux.
+*/
+namespace geom {
+
+/*A point with coordinates of type T
+*
+* Point, in doubles, is what the app and most engines use. IntPoint holds
+* exact integer coordinates in half the memory, see exact.h for the
+* arithmetic on it, and FloatPoint is the float equivalent.
+*/
+template <class T>
+struct PointT
+{
+    T x;
+    T y;
+};
+
+typedef PointT<double>  Point;
+typedef PointT<float>   FloatPoint;
+typedef PointT<int32_t> IntPoint;
+
+template <class T>
+inline bool operator==(const PointT<T>& a, const PointT<T>& b) { return a.x == b.x && a.y == b.y; }
+template <class T>
+inline bool operator!=(const PointT<T>& a, const PointT<T>& b) { return !(a == b); }
+inline Point operator+(const Point& a, const Point& b) { return { a.x + b.x, a.y + b.y }; }
+inline Point operator-(const Point& a, const Point& b) { return { a.x - b.x, a.y - b.y }; }
+inline Point operator*(double s, const Point& a) { return { s * a.x, s * a.y }; }
+
+inline double dot(const Point& a, const Point& b) { return a.x * b.x + a.y * b.y; }
+inline double cross(const Point& a, const Point& b) { return a.x * b.y - a.y * b.x; }
+
+//twice the signed area of abc, > 0 when c is left of a->b
+inline double orient(const Point& a, const Point& b, const Point& c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+//lexicographic (x, then y) ordering used to pick hull start points
+inline bool lessXY(const Point& a, const Point& b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+/*x and y kept in separate arrays, such as the columns of a mapped point file
+*
+* Reads like a Point array, pts[i], so the hull engines that take one can run
+* over columns without copying them into Points first.
+*/
+template <class T>
+struct Columns
+{
+    const T* x;
+    const T* y;
+
+    Point operator[](size_t i) const { return { (double)x[i], (double)y[i] }; }
+};
+
+}
+
+#endif
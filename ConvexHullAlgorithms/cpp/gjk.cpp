@@ -0,0 +1,544 @@
+#include "gjk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "simd.h"
+
+namespace geom {
+
+namespace {
+
+const int    maxIterations = 32;
+const int    maxEpaIterations = 64;
+const double epsilon = 1e-12;
+//EPA stops once a support point gains less than this, relative to the depth
+const double epaTolerance = 1e-10;
+
+const int    maxToiIterations = 64;
+//on a rounded shape GJK stops once a support point gains less than this, relative to the distance
+const double roundTolerance = 1e-9;
+
+/*One of the shapes: a polygon, with a SupportMap when the caller built one,
+* or a rounded one whose n "vertices" are the arcs of a DiscHull. It is
+* placed by a rotation and then an offset that start out as the identity.
+*/
+struct Shape
+{
+    const Point*      p;
+    size_t            n;
+    const SupportMap* map;
+    const DiscHull*   round;
+    double            cosine, sine;
+    Point             offset;
+
+    Shape(const Point* pts, size_t count, const SupportMap* supportMap)
+        : p(pts), n(count), map(supportMap), round(nullptr), cosine(1), sine(0), offset({ 0, 0 })
+    {
+    }
+
+    explicit Shape(const DiscHull& hull)
+        : p(nullptr), n(hull.size()), map(nullptr), round(&hull), cosine(1), sine(0), offset({ 0, 0 })
+    {
+    }
+
+    //places the shape where motion has taken it at time t
+    void moveTo(const Motion& motion, double t)
+    {
+        cosine = std::cos(motion.angularVelocity * t);
+        sine = std::sin(motion.angularVelocity * t);
+        offset = motion.center + t * motion.velocity - rotate(motion.center);
+    }
+
+    Point rotate(const Point& v) const { return { cosine * v.x - sine * v.y, sine * v.x + cosine * v.y }; }
+
+    //vertex i, or the middle of arc i, which is as good a support point as any of it
+    Point operator[](size_t i) const
+    {
+        if (round) {
+            const DiscArc& arc = round->arcs()[i];
+            const double t = 0.5 * (arc.from + arc.to);
+            return rotate(arc.center + arc.radius * Point{ std::cos(t), std::sin(t) }) + offset;
+        }
+        return rotate(p[i]) + offset;
+    }
+
+    //the point support(d) returned i for, which on an arc depends on d
+    Point at(size_t i, const Point& d) const
+    {
+        if (round) {
+            const double len = std::sqrt(dot(d, d));
+            const DiscArc& arc = round->arcs()[i];
+            return rotate(arc.center) + offset + (len > 0 ? (arc.radius / len) * d : Point{ 0, 0 });
+        }
+        return (*this)[i];
+    }
+
+    //index of the vertex furthest along d
+    size_t support(const Point& d) const
+    {
+        return extreme({ cosine * d.x + sine * d.y, cosine * d.y - sine * d.x });
+    }
+
+    //the same along d as the vertices were given, before any move
+    size_t extreme(const Point& d) const
+    {
+        return round ? round->extreme(d) : map ? map->extreme(d) : simd::argmaxDot(&p[0].x, 2, n, d);
+    }
+};
+
+//vertex of the Minkowski difference A - B with the indices that produced it
+struct SimplexVertex
+{
+    Point  wA, wB, w;
+    double weight;  //barycentric coordinate of the closest point
+    size_t iA, iB;
+};
+
+struct Simplex
+{
+    SimplexVertex v[3];
+    int           count;
+
+    void set(int k, size_t iA, const Point& wA, size_t iB, const Point& wB)
+    {
+        v[k].iA = iA;
+        v[k].iB = iB;
+        v[k].wA = wA;
+        v[k].wB = wB;
+        v[k].w = wA - wB;
+        v[k].weight = 1;
+    }
+
+    //closest point of the segment w1 w2 to the origin, dropping a vertex if it is a corner
+    void solve2()
+    {
+        const Point e12 = v[1].w - v[0].w;
+        const double d2 = -dot(v[0].w, e12);
+        if (d2 <= 0) {
+            v[0].weight = 1;
+            count = 1;
+            return;
+        }
+        const double d1 = dot(v[1].w, e12);
+        if (d1 <= 0) {
+            v[1].weight = 1;
+            v[0] = v[1];
+            count = 1;
+            return;
+        }
+        const double inv = 1 / (d1 + d2);
+        v[0].weight = d1 * inv;
+        v[1].weight = d2 * inv;
+    }
+
+    //closest feature of the triangle to the origin, keeps all 3 only when it contains it
+    void solve3()
+    {
+        const Point w1 = v[0].w, w2 = v[1].w, w3 = v[2].w;
+
+        const Point e12 = w2 - w1;
+        const double d12_1 = dot(w2, e12);
+        const double d12_2 = -dot(w1, e12);
+
+        const Point e13 = w3 - w1;
+        const double d13_1 = dot(w3, e13);
+        const double d13_2 = -dot(w1, e13);
+
+        const Point e23 = w3 - w2;
+        const double d23_1 = dot(w3, e23);
+        const double d23_2 = -dot(w2, e23);
+
+        const double n123 = cross(e12, e13);
+        const double d123_1 = n123 * cross(w2, w3);
+        const double d123_2 = n123 * cross(w3, w1);
+        const double d123_3 = n123 * cross(w1, w2);
+
+        if (d12_2 <= 0 && d13_2 <= 0) {
+            v[0].weight = 1;
+            count = 1;
+        }
+        else if (d12_1 > 0 && d12_2 > 0 && d123_3 <= 0) {
+            const double inv = 1 / (d12_1 + d12_2);
+            v[0].weight = d12_1 * inv;
+            v[1].weight = d12_2 * inv;
+            count = 2;
+        }
+        else if (d13_1 > 0 && d13_2 > 0 && d123_2 <= 0) {
+            const double inv = 1 / (d13_1 + d13_2);
+            v[0].weight = d13_1 * inv;
+            v[2].weight = d13_2 * inv;
+            v[1] = v[2];
+            count = 2;
+        }
+        else if (d12_1 <= 0 && d23_2 <= 0) {
+            v[1].weight = 1;
+            v[0] = v[1];
+            count = 1;
+        }
+        else if (d13_1 <= 0 && d23_1 <= 0) {
+            v[2].weight = 1;
+            v[0] = v[2];
+            count = 1;
+        }
+        else if (d23_1 > 0 && d23_2 > 0 && d123_1 <= 0) {
+            const double inv = 1 / (d23_1 + d23_2);
+            v[1].weight = d23_1 * inv;
+            v[2].weight = d23_2 * inv;
+            v[0] = v[2];
+            count = 2;
+        }
+        else {
+            const double inv = 1 / (d123_1 + d123_2 + d123_3);
+            v[0].weight = d123_1 * inv;
+            v[1].weight = d123_2 * inv;
+            v[2].weight = d123_3 * inv;
+            count = 3;
+        }
+    }
+
+    //direction from the simplex towards the origin
+    Point searchDirection() const
+    {
+        if (count == 1) {
+            return -1.0 * v[0].w;
+        }
+        const Point e12 = v[1].w - v[0].w;
+        if (cross(e12, -1.0 * v[0].w) > 0) {
+            return { -e12.y, e12.x };
+        }
+        return { e12.y, -e12.x };
+    }
+
+    void witnessPoints(Point& pA, Point& pB) const
+    {
+        pA = { 0, 0 };
+        pB = { 0, 0 };
+        for (int k = 0; k < count; k++) {
+            pA = pA + v[k].weight * v[k].wA;
+            pB = pB + v[k].weight * v[k].wB;
+        }
+    }
+};
+
+GjkResult gjkOf(const Shape& a, const Shape& b, GjkCache* cache)
+{
+    GjkResult result = { false, 0, {}, {}, 0 };
+    const size_t n = a.n, m = b.n;
+    if (n == 0 || m == 0) {
+        return result;
+    }
+
+    const bool curved = a.round || b.round;
+    Simplex s;
+    s.count = 0;
+    if (cache && cache->count > 0 && cache->count <= 3) {
+        for (size_t k = 0; k < cache->count; k++) {
+            if (cache->indexA[k] >= n || cache->indexB[k] >= m) {
+                s.count = 0;
+                break;
+            }
+            s.set(s.count++, cache->indexA[k], a[cache->indexA[k]], cache->indexB[k], b[cache->indexB[k]]);
+        }
+    }
+    if (s.count == 0) {
+        s.set(0, 0, a[0], 0, b[0]);
+        s.count = 1;
+    }
+
+    while (result.iterations < maxIterations) {
+        //remember what we had so a repeated support point can be spotted
+        size_t savedA[3], savedB[3];
+        const int saved = s.count;
+        for (int k = 0; k < saved; k++) {
+            savedA[k] = s.v[k].iA;
+            savedB[k] = s.v[k].iB;
+        }
+
+        if (s.count == 2) {
+            s.solve2();
+        }
+        else if (s.count == 3) {
+            s.solve3();
+        }
+        if (s.count == 3) {
+            break;
+        }
+
+        const Point d = s.searchDirection();
+        if (dot(d, d) < epsilon * epsilon) {
+            //origin is on the simplex, the shapes are touching
+            break;
+        }
+
+        const size_t iA = a.support(d);
+        const size_t iB = b.support(-1.0 * d);
+        const Point wA = a.at(iA, d), wB = b.at(iB, -1.0 * d);
+        result.iterations++;
+
+        bool duplicate = false;
+        if (curved) {
+            //a curve has a new support point for every direction, stop when
+            //it gets no nearer the origin than the simplex already is
+            double reached = -HUGE_VAL;
+            for (int k = 0; k < s.count; k++) {
+                reached = (std::max)(reached, dot(s.v[k].w, d));
+            }
+            const double len = std::sqrt(dot(d, d));
+            const double gain = (dot(wA - wB, d) - reached) / len;
+            duplicate = gain <= roundTolerance * (std::max)(1.0, std::fabs(reached) / len);
+        }
+        else {
+            for (int k = 0; k < saved; k++) {
+                if (savedA[k] == iA && savedB[k] == iB) {
+                    duplicate = true;
+                    break;
+                }
+            }
+        }
+        if (duplicate) {
+            break;
+        }
+        s.set(s.count++, iA, wA, iB, wB);
+    }
+
+    s.witnessPoints(result.pointA, result.pointB);
+    const Point gap = result.pointA - result.pointB;
+    result.distance = s.count == 3 ? 0 : std::sqrt(dot(gap, gap));
+    result.intersecting = result.distance <= epsilon;
+
+    if (cache) {
+        cache->count = s.count;
+        for (int k = 0; k < s.count; k++) {
+            cache->indexA[k] = s.v[k].iA;
+            cache->indexB[k] = s.v[k].iB;
+        }
+    }
+    return result;
+}
+
+//vertex of the polytope EPA grows inside A - B
+struct PolytopeVertex
+{
+    Point  wA, wB, w;
+    size_t iA, iB;
+};
+
+PolytopeVertex supportVertex(const Shape& a, const Shape& b, const Point& d)
+{
+    const size_t iA = a.support(d);
+    const size_t iB = b.support(-1.0 * d);
+    const Point wA = a.at(iA, d), wB = b.at(iB, -1.0 * d);
+    return { wA, wB, wA - wB, iA, iB };
+}
+
+//the same support points, on an arc that takes the same point of it too
+bool sameVertex(const PolytopeVertex& u, const PolytopeVertex& v)
+{
+    return u.iA == v.iA && u.iB == v.iB && u.w == v.w;
+}
+
+EpaResult epaOf(const Shape& a, const Shape& b, GjkCache* cache)
+{
+    const GjkResult g = gjkOf(a, b, cache);
+    EpaResult result = { g.intersecting, 0, { 0, 0 }, g.pointA, g.pointB, 0 };
+    if (!g.intersecting) {
+        const Point gap = g.pointB - g.pointA;
+        if (g.distance > 0) {
+            result.normal = (1 / g.distance) * gap;
+        }
+        return result;
+    }
+
+    /*Support points in the four axis directions, in counter-clockwise order.
+    * Every vertex is a support point, and a support point for the normal of
+    * an edge lies between the edge's ends, so the polygon stays convex as it
+    * grows. It may start as a single edge, then its two sides are its edges.
+    */
+    const Point axes[4] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    std::vector<PolytopeVertex> poly;
+    for (const Point& d : axes) {
+        const PolytopeVertex v = supportVertex(a, b, d);
+        if (poly.empty() || (!sameVertex(v, poly.back()) && !sameVertex(v, poly.front()))) {
+            poly.push_back(v);
+        }
+    }
+    if (poly.size() < 2) {
+        //A - B is a single point, the origin
+        return result;
+    }
+
+    size_t nearest = 0;
+    Point normal = { 0, 0 };
+    double depth = 0;
+    for (;;) {
+        //edge whose line is nearest the origin, outward normals of a counter-clockwise
+        //polygon, the distance is negative while the origin is still outside it
+        depth = HUGE_VAL;
+        for (size_t i = 0; i < poly.size(); i++) {
+            const Point e = poly[(i + 1) % poly.size()].w - poly[i].w;
+            const double len = std::sqrt(dot(e, e));
+            if (len <= epsilon) {
+                continue;
+            }
+            const Point out = { e.y / len, -e.x / len };
+            const double d = dot(out, poly[i].w);
+            if (d < depth) {
+                depth = d;
+                normal = out;
+                nearest = i;
+            }
+        }
+        if (depth == HUGE_VAL) {
+            //every vertex at the same position, A - B is the origin alone
+            return result;
+        }
+        if (result.iterations >= maxEpaIterations) {
+            break;
+        }
+
+        const PolytopeVertex v = supportVertex(a, b, normal);
+        result.iterations++;
+        const PolytopeVertex& from = poly[nearest];
+        const PolytopeVertex& to = poly[(nearest + 1) % poly.size()];
+        if (sameVertex(v, from) || sameVertex(v, to) ||
+            dot(v.w, normal) - depth <= epaTolerance * (std::max)(1.0, depth)) {
+            break;
+        }
+        poly.insert(poly.begin() + nearest + 1, v);
+    }
+
+    //contact points from where the origin projects onto the nearest edge
+    const PolytopeVertex& from = poly[nearest];
+    const PolytopeVertex& to = poly[(nearest + 1) % poly.size()];
+    const Point e = to.w - from.w;
+    double t = -dot(from.w, e) / dot(e, e);
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    result.depth = depth > 0 ? depth : 0;
+    result.normal = normal;
+    result.pointA = from.wA + t * (to.wA - from.wA);
+    result.pointB = from.wB + t * (to.wB - from.wB);
+    return result;
+}
+
+/*No vertex is further than this from the center the shape turns about. It
+* is the furthest corner of the bounding box, which is four support searches
+* rather than a pass over the vertices and overestimates by at most sqrt(2).
+*/
+double turnRadius(const Shape& shape, const Motion& motion)
+{
+    const double right = shape.p[shape.extreme({ 1, 0 })].x - motion.center.x;
+    const double top = shape.p[shape.extreme({ 0, 1 })].y - motion.center.y;
+    const double left = motion.center.x - shape.p[shape.extreme({ -1, 0 })].x;
+    const double bottom = motion.center.y - shape.p[shape.extreme({ 0, -1 })].y;
+    const double x = (std::max)(right, left), y = (std::max)(top, bottom);
+    return std::sqrt(x * x + y * y);
+}
+
+ToiResult timeOfImpactOf(Shape& a, const Motion& motionA, Shape& b, const Motion& motionB,
+                         double tMax, double tolerance, GjkCache* cache)
+{
+    ToiResult result = { false, tMax, { 0, 0 }, {}, {}, 0 };
+    if (a.n == 0 || b.n == 0) {
+        return result;
+    }
+
+    //no point of A moves faster than this, nor of B, in any direction
+    const double spinA = motionA.angularVelocity == 0 ? 0 : std::fabs(motionA.angularVelocity) * turnRadius(a, motionA);
+    const double spinB = motionB.angularVelocity == 0 ? 0 : std::fabs(motionB.angularVelocity) * turnRadius(b, motionB);
+    const Point closing = motionA.velocity - motionB.velocity;
+
+    double t = 0;
+    for (;;) {
+        a.moveTo(motionA, t);
+        b.moveTo(motionB, t);
+        const GjkResult g = gjkOf(a, b, cache);
+        result.iterations++;
+        result.time = t;
+        result.pointA = g.pointA;
+        result.pointB = g.pointB;
+        if (g.distance > 0) {
+            result.normal = (1 / g.distance) * (g.pointB - g.pointA);
+        }
+        if (g.distance <= tolerance) {
+            result.hit = true;
+            return result;
+        }
+
+        //the gap along the normal shrinks no faster than this, so it can't
+        //close before dt, which stops half a tolerance short of touching
+        const double speed = dot(closing, result.normal) + spinA + spinB;
+        if (speed <= 0) {
+            //moving apart without turning, the distance only grows from here
+            result.time = tMax;
+            return result;
+        }
+        const double dt = (g.distance - 0.5 * tolerance) / speed;
+        if (t + dt >= tMax) {
+            result.time = tMax;
+            return result;
+        }
+        if (result.iterations >= maxToiIterations) {
+            return result;
+        }
+        t += dt;
+    }
+}
+
+}
+
+Point Motion::at(const Point& p, double t) const
+{
+    const double c = std::cos(angularVelocity * t), s = std::sin(angularVelocity * t);
+    const Point v = p - center;
+    return center + t * velocity + Point{ c * v.x - s * v.y, s * v.x + c * v.y };
+}
+
+GjkResult gjk(const Point* a, size_t n, const Point* b, size_t m, GjkCache* cache)
+{
+    return gjkOf({ a, n, nullptr }, { b, m, nullptr }, cache);
+}
+
+GjkResult gjk(const SupportMap& a, const SupportMap& b, GjkCache* cache)
+{
+    return gjkOf({ a.points(), a.size(), &a }, { b.points(), b.size(), &b }, cache);
+}
+
+EpaResult epa(const Point* a, size_t n, const Point* b, size_t m, GjkCache* cache)
+{
+    return epaOf({ a, n, nullptr }, { b, m, nullptr }, cache);
+}
+
+EpaResult epa(const SupportMap& a, const SupportMap& b, GjkCache* cache)
+{
+    return epaOf({ a.points(), a.size(), &a }, { b.points(), b.size(), &b }, cache);
+}
+
+GjkResult gjk(const DiscHull& a, const DiscHull& b, GjkCache* cache)
+{
+    return gjkOf(Shape(a), Shape(b), cache);
+}
+
+EpaResult epa(const DiscHull& a, const DiscHull& b, GjkCache* cache)
+{
+    return epaOf(Shape(a), Shape(b), cache);
+}
+
+ToiResult timeOfImpact(const Point* a, size_t n, const Motion& motionA,
+                       const Point* b, size_t m, const Motion& motionB,
+                       double tMax, double tolerance, GjkCache* cache)
+{
+    Shape shapeA(a, n, nullptr), shapeB(b, m, nullptr);
+    return timeOfImpactOf(shapeA, motionA, shapeB, motionB, tMax, tolerance, cache);
+}
+
+ToiResult timeOfImpact(const SupportMap& a, const Motion& motionA,
+                       const SupportMap& b, const Motion& motionB,
+                       double tMax, double tolerance, GjkCache* cache)
+{
+    Shape shapeA(a.points(), a.size(), &a), shapeB(b.points(), b.size(), &b);
+    return timeOfImpactOf(shapeA, motionA, shapeB, motionB, tMax, tolerance, cache);
+}
+
+}
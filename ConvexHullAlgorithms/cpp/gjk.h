@@ -0,0 +1,135 @@
+#ifndef _GJK_H
+#define _GJK_H
+
+#include <cstddef>
+
+#include "dischull.h"
+#include "geometry.h"
+#include "supportmap.h"
+
+namespace geom {
+
+/*Terminating simplex of the last GJK query between one pair of shapes
+*
+* Only vertex indices are kept, so the cache stays meaningful after the
+* shapes move. Keep one per pair and pass it to every query of that pair.
+*/
+struct GjkCache
+{
+    size_t count = 0;
+    size_t indexA[3];
+    size_t indexB[3];
+};
+
+struct GjkResult
+{
+    bool   intersecting;
+    double distance;
+    Point  pointA;      //closest point on A, only meaningful when not intersecting
+    Point  pointB;      //closest point on B
+    int    iterations;  //support evaluations that were needed
+};
+
+/*Distance and intersection test between two convex polygons with GJK
+*
+* @param a: vertices of A, any order (hull vertices are enough)
+* @param b: vertices of B
+* @param cache: warm start in/out, may be null. The query starts from the
+*               cached simplex and writes back the one it terminated with,
+*               so shapes that barely moved finish in one or two iterations.
+*/
+GjkResult gjk(const Point* a, size_t n, const Point* b, size_t m, GjkCache* cache = nullptr);
+
+/*The same query with each support search a binary search over the map
+* instead of a scan over every vertex, for hulls that are queried more often
+* than they change. Indices in the cache are into the maps' vertices.
+*/
+GjkResult gjk(const SupportMap& a, const SupportMap& b, GjkCache* cache = nullptr);
+
+/*The same query on rounded shapes, such as hulls of discs or polygons grown
+* by a radius. Arcs have a support point for every direction, so instead of
+* on a repeated support point it stops once a new one gets no nearer the
+* origin, to about 1e-9 of the distance. Indices in the cache are arcs.
+*/
+GjkResult gjk(const DiscHull& a, const DiscHull& b, GjkCache* cache = nullptr);
+
+struct EpaResult
+{
+    bool   intersecting;
+    double depth;       //how far B has to move along normal to only touch A, 0 when apart
+    Point  normal;      //unit length, from A towards B
+    Point  pointA;      //deepest point of B inside A is pointB, its contact on A's boundary is pointA
+    Point  pointB;
+    int    iterations;  //support evaluations after GJK's
+};
+
+/*Penetration depth and contact normal of two convex polygons with EPA
+*
+* Runs gjk() first. If the polygons overlap, a polygon of support points of
+* A - B is grown inside that difference one support point at a time, always
+* out through the edge nearest the origin, until that edge is on the
+* boundary. Every step costs two support searches, never the n * m
+* differences. Its distance is the depth and its
+* normal the contact normal: moving B by depth * normal, or A by
+* -depth * normal, leaves them touching. Apart polygons get depth 0 and
+* GJK's closest points.
+*
+* @param cache: as for gjk()
+*/
+EpaResult epa(const Point* a, size_t n, const Point* b, size_t m, GjkCache* cache = nullptr);
+EpaResult epa(const SupportMap& a, const SupportMap& b, GjkCache* cache = nullptr);
+EpaResult epa(const DiscHull& a, const DiscHull& b, GjkCache* cache = nullptr);
+
+/*Rigid motion of a shape from time 0: it turns about center while center
+* moves in a straight line, so a point p of the shape at time 0 is at
+* center + t * velocity + (p - center) turned by angularVelocity * t
+*/
+struct Motion
+{
+    Point  velocity = { 0, 0 };
+    double angularVelocity = 0;     //radians per unit of time, counter-clockwise
+    Point  center = { 0, 0 };       //where the shape turns about at time 0
+
+    Point at(const Point& p, double t) const;
+};
+
+struct ToiResult
+{
+    bool   hit;
+    double time;        //when they first come within tolerance, else how far it is safe to advance
+    Point  normal;      //unit length, from A towards B at time, zero if they overlap at time 0
+    Point  pointA;      //closest points at time, already moved
+    Point  pointB;
+    int    iterations;  //gjk() queries
+};
+
+/*Time of impact of two moving convex polygons by conservative advancement
+*
+* Each step runs gjk() on the polygons where they are at t, then moves t on
+* by the gap over the fastest the gap can close: the relative velocity along
+* the normal, plus for a turning shape its angular speed times the furthest
+* its vertices are from its center. The polygons can't touch before that, so
+* unlike testing them at a few times along the way, a fast or thin shape
+* can't pass through the other between two tests. The simplex of one step
+* warm starts the next, so once they are close each step is a few support
+* searches.
+*
+* @param a: vertices of A at time 0, any order
+* @param tMax: end of the motion, the query looks at [0, tMax]
+* @param tolerance: > 0, they count as touching within this distance
+* @param cache: as for gjk()
+* @return hit with the impact time, or no hit with time tMax when they stay
+*         apart. After 64 steps, which takes a shape turning fast past
+*         a close one, it stops short with no hit: the polygons
+*         are apart until time, so it is still safe to advance that far.
+*/
+ToiResult timeOfImpact(const Point* a, size_t n, const Motion& motionA,
+                       const Point* b, size_t m, const Motion& motionB,
+                       double tMax, double tolerance, GjkCache* cache = nullptr);
+ToiResult timeOfImpact(const SupportMap& a, const Motion& motionA,
+                       const SupportMap& b, const Motion& motionB,
+                       double tMax, double tolerance, GjkCache* cache = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,506 @@
+#include "hull.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+#include "exact.h"
+#include "predicates.h"
+#include "simd.h"
+#include "threadpool.h"
+
+namespace geom {
+
+namespace {
+
+//point plus the index it came from, so the working buffer can be reordered in place
+template <class T>
+struct ItemT
+{
+    PointT<T> p;
+    size_t    index;
+};
+
+typedef ItemT<double> Item;
+
+//the kernels read Items as records of three doubles
+static_assert(sizeof(Item) == 3 * sizeof(double) && offsetof(Item, p) == 0, "Item layout");
+const size_t itemStride = sizeof(Item) / sizeof(double);
+
+/*One pending piece of work for the iterative QuickHull.
+*
+* A segment frame owns items[lo, hi), all of which lie strictly right of a->b.
+* An emit frame just appends index to the output when it is popped, which
+* keeps the output in hull order without recursion.
+*/
+template <class T>
+struct Frame
+{
+    PointT<T> a, b;
+    size_t    lo, hi;
+    size_t    index;
+    bool      emit;
+};
+
+//best candidate for the next hull vertex of a segment
+using simd::Farthest;
+
+//farthest point from a->b is always a hull vertex, ties go to the one
+//furthest along a->b so collinear points never become vertices
+inline bool fartherThan(double d, double along, const Farthest& best)
+{
+    return d > best.dist || (d == best.dist && along > best.along);
+}
+
+Farthest findFarthest(const Item* items, size_t lo, size_t hi, const Point& a, const Point& b)
+{
+    Farthest best = simd::farthestRight(&items[lo].p.x, itemStride, hi - lo, a, b);
+    best.at += lo;
+    return best;
+}
+
+//the same search in the coordinate type's own arithmetic, exact for integers
+template <class T>
+struct FarthestOf
+{
+    typedef typename Exact<T>::Area Area;
+
+    size_t at;
+    Area   dist;
+    Area   along;
+};
+
+template <class T>
+FarthestOf<T> findFarthest(const ItemT<T>* items, size_t lo, size_t hi, const PointT<T>& a, const PointT<T>& b)
+{
+    typedef Exact<T> E;
+    FarthestOf<T> best = { lo, E::orient(b, a, items[lo].p), E::along(a, b, items[lo].p) };
+    for (size_t i = lo + 1; i < hi; i++) {
+        const typename E::Area d = E::orient(b, a, items[i].p);
+        const typename E::Area along = E::along(a, b, items[i].p);
+        if (best.dist < d || (d == best.dist && best.along < along)) {
+            best = { i, d, along };
+        }
+    }
+    return best;
+}
+
+//items classified per block before any is moved
+const size_t partitionBlock = 1024;
+
+//moves every item in [lo, hi) strictly right of a->b to the front, returns the split
+size_t partitionRight(Item* items, size_t lo, size_t hi, const Point& a, const Point& b)
+{
+    int8_t side[partitionBlock];
+    size_t mid = lo;
+    for (size_t l = lo; l < hi; l += partitionBlock) {
+        const size_t h = std::min(hi, l + partitionBlock);
+        simd::classify(&items[l].p.x, itemStride, h - l, a, b, side);
+        for (size_t i = l; i < h; i++) {
+            //unconditional so the loop does not branch on the side, [mid, i) is all
+            //outside so swapping two outside items is harmless
+            const Item t = items[i];
+            items[i] = items[mid];
+            items[mid] = t;
+            mid += side[i - l] < 0;
+        }
+    }
+    return mid;
+}
+
+template <class T>
+size_t partitionRight(ItemT<T>* items, size_t lo, size_t hi, const PointT<T>& a, const PointT<T>& b)
+{
+    size_t mid = lo;
+    for (size_t i = lo; i < hi; i++) {
+        const ItemT<T> t = items[i];
+        items[i] = items[mid];
+        items[mid] = t;
+        mid += Exact<T>::side(a, b, t.p) < 0;
+    }
+    return mid;
+}
+
+/*Appends the hull vertices strictly between a and b to out, in order
+*
+* @param items: working buffer, [lo, hi) all lie strictly right of a->b and get reordered
+*/
+template <class T>
+void hullSegment(ItemT<T>* items, size_t lo, size_t hi, const PointT<T>& a, const PointT<T>& b, std::vector<size_t>& out)
+{
+    std::vector<Frame<T>> stack;
+    stack.push_back({ a, b, lo, hi, 0, false });
+
+    while (!stack.empty()) {
+        const Frame<T> f = stack.back();
+        stack.pop_back();
+
+        if (f.emit) {
+            out.push_back(f.index);
+            continue;
+        }
+        if (f.lo == f.hi) {
+            continue;
+        }
+
+        const size_t    at = findFarthest(items, f.lo, f.hi, f.a, f.b).at;
+        const PointT<T> c = items[at].p;
+        const size_t    cIndex = items[at].index;
+
+        //everything inside triangle a, c, b is dropped here
+        const size_t mid = partitionRight(items, f.lo, f.hi, f.a, c);
+        const size_t end = partitionRight(items, mid, f.hi, c, f.b);
+
+        stack.push_back({ c, f.b, mid, end, 0, false });
+        stack.push_back({ {}, {}, 0, 0, cIndex, true });
+        stack.push_back({ f.a, c, f.lo, mid, 0, false });
+    }
+}
+
+//indices of the lexicographically lowest and highest points in [lo, hi)
+void findExtremes(const Point* pts, size_t lo, size_t hi, size_t& min, size_t& max)
+{
+    simd::extremesXY(&pts[lo].x, 2, hi - lo, min, max);
+    min += lo;
+    max += lo;
+}
+
+template <class T>
+void findExtremes(const Columns<T>& pts, size_t lo, size_t hi, size_t& min, size_t& max)
+{
+    simd::extremesXY(pts.x + lo, pts.y + lo, hi - lo, min, max);
+    min += lo;
+    max += lo;
+}
+
+//lessXY() for any coordinate type
+template <class T>
+bool before(const PointT<T>& a, const PointT<T>& b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+template <class T>
+void findExtremes(const PointT<T>* pts, size_t lo, size_t hi, size_t& min, size_t& max)
+{
+    min = max = lo;
+    for (size_t i = lo + 1; i < hi; i++) {
+        if (before(pts[i], pts[min])) min = i;
+        if (before(pts[max], pts[i])) max = i;
+    }
+}
+
+//side of a->b of every point, see simd::classify()
+simd::SideCounts classifyAll(const Point* pts, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+    return simd::classify(&pts[0].x, 2, n, a, b, side);
+}
+
+template <class T>
+simd::SideCounts classifyAll(const Columns<T>& pts, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+    return simd::classify(pts.x, pts.y, n, a, b, side);
+}
+
+template <class T>
+simd::SideCounts classifyAll(const PointT<T>* pts, size_t n, const PointT<T>& a, const PointT<T>& b, int8_t* side)
+{
+    simd::SideCounts counts = { 0, 0 };
+    for (size_t i = 0; i < n; i++) {
+        side[i] = (int8_t)Exact<T>::side(a, b, pts[i]);
+        counts.right += side[i] < 0;
+        counts.left += side[i] > 0;
+    }
+    return counts;
+}
+
+/*Drops the hull vertices that are not strictly convex
+*
+* Each segment's farthest point is picked with float distances, so on nearly
+* collinear input a point a rounding error short of the true farthest one can
+* become a vertex. The side tests are exact, so every point is still inside
+* the polygon and removing its flat and reflex vertices leaves the exact
+* hull. The first vertex, the lowest point, is always a true one.
+*/
+template <class T, class Source>
+void dropFlat(const Source& pts, std::vector<size_t>& hull)
+{
+    if (hull.size() < 3) {
+        return;
+    }
+    size_t k = 1;
+    for (size_t i = 1; i <= hull.size(); i++) {
+        const size_t v = i < hull.size() ? hull[i] : hull[0];
+        while (k >= 2 && Exact<T>::side(pts[hull[k - 2]], pts[hull[k - 1]], pts[v]) <= 0) {
+            k--;
+        }
+        if (i < hull.size()) {
+            hull[k++] = v;
+        }
+    }
+    hull.resize(k);
+}
+
+/*The working buffer is filled straight from pts, a PointT array or Columns,
+* and holds the coordinates pts[i] gives, doubles for Columns
+*/
+template <class Source>
+std::vector<size_t> quickHullOf(const Source& pts, size_t n)
+{
+    typedef typename std::decay<decltype(pts[0])>::type P;
+    typedef decltype(P::x) T;
+
+    std::vector<size_t> hull;
+    if (n == 0) {
+        return hull;
+    }
+
+    size_t lo, hi;
+    findExtremes(pts, 0, n, lo, hi);
+    hull.push_back(lo);
+    const P a = pts[lo];
+    const P b = pts[hi];
+    if (a == b) {
+        return hull;
+    }
+
+    //lower set (right of a->b) goes first, upper set (right of b->a) after it
+    std::vector<int8_t> side(n);
+    const simd::SideCounts counts = classifyAll(pts, n, a, b, side.data());
+    std::vector<ItemT<T>> items(counts.right + counts.left);
+    const size_t lowerEnd = counts.right;
+    size_t nl = 0, nu = lowerEnd;
+    for (size_t i = 0; i < n; i++) {
+        if (side[i] < 0) items[nl++] = { pts[i], i };
+        else if (side[i] > 0) items[nu++] = { pts[i], i };
+    }
+
+    hullSegment(items.data(), 0, lowerEnd, a, b, hull);
+    hull.push_back(hi);
+    hullSegment(items.data(), lowerEnd, items.size(), b, a, hull);
+    if (!Exact<T>::exact) {
+        dropFlat<T>(pts, hull);
+    }
+    return hull;
+}
+
+//below this many points a segment is finished sequentially by the calling task
+const size_t segmentCutoff = 1 << 15;
+
+//below this many points the whole hull runs on one thread
+const size_t parallelCutoff = 1 << 17;
+
+/*State shared by the tasks of one parallel QuickHull.
+*
+* Segments larger than segmentCutoff are partitioned out of place, chunk by
+* chunk, from one buffer into the other at the same offsets. Child segments
+* then read from the buffer their parent wrote, so nothing is copied back.
+*/
+struct ParallelHull
+{
+    TaskPool& pool;
+    size_t    grain;
+
+    void segment(Item* src, Item* dst, size_t lo, size_t hi, const Point& a, const Point& b, std::vector<size_t>& out)
+    {
+        if (hi - lo < segmentCutoff) {
+            hullSegment(src, lo, hi, a, b, out);
+            return;
+        }
+
+        const size_t chunks = (hi - lo + grain - 1) / grain;
+        std::vector<Farthest> best(chunks);
+        pool.parallelFor(0, chunks, 1, [&](size_t c0, size_t c1) {
+            for (size_t c = c0; c < c1; c++) {
+                const size_t l = lo + c * grain;
+                best[c] = findFarthest(src, l, std::min(hi, l + grain), a, b);
+            }
+        });
+        Farthest far = best[0];
+        for (const Farthest& f : best) {
+            if (fartherThan(f.dist, f.along, far)) {
+                far = f;
+            }
+        }
+        const Point  c = src[far.at].p;
+        const size_t cIndex = src[far.at].index;
+
+        //count, prefix sum, scatter: left of the hull edge a->c first, c->b after it
+        std::vector<size_t> leftCount(chunks), rightCount(chunks);
+        pool.parallelFor(0, chunks, 1, [&](size_t c0, size_t c1) {
+            for (size_t k = c0; k < c1; k++) {
+                const size_t l = lo + k * grain;
+                const size_t h = std::min(hi, l + grain);
+                size_t nl = 0, nr = 0;
+                for (size_t i = l; i < h; i++) {
+                    if (orient2d(a, c, src[i].p) < 0) nl++;
+                    else if (orient2d(c, b, src[i].p) < 0) nr++;
+                }
+                leftCount[k] = nl;
+                rightCount[k] = nr;
+            }
+        });
+        size_t leftTotal = 0, rightTotal = 0;
+        for (size_t k = 0; k < chunks; k++) {
+            const size_t nl = leftCount[k], nr = rightCount[k];
+            leftCount[k] = leftTotal;
+            rightCount[k] = rightTotal;
+            leftTotal += nl;
+            rightTotal += nr;
+        }
+        const size_t mid = lo + leftTotal;
+        pool.parallelFor(0, chunks, 1, [&](size_t c0, size_t c1) {
+            for (size_t k = c0; k < c1; k++) {
+                const size_t l = lo + k * grain;
+                const size_t h = std::min(hi, l + grain);
+                size_t nl = lo + leftCount[k], nr = mid + rightCount[k];
+                for (size_t i = l; i < h; i++) {
+                    if (orient2d(a, c, src[i].p) < 0) dst[nl++] = src[i];
+                    else if (orient2d(c, b, src[i].p) < 0) dst[nr++] = src[i];
+                }
+            }
+        });
+
+        std::vector<size_t> left;
+        TaskGroup group;
+        pool.spawn(group, [&] { segment(dst, src, lo, mid, a, c, left); });
+        std::vector<size_t> right;
+        segment(dst, src, mid, mid + rightTotal, c, b, right);
+        pool.wait(group);
+
+        out.insert(out.end(), left.begin(), left.end());
+        out.push_back(cIndex);
+        out.insert(out.end(), right.begin(), right.end());
+    }
+};
+
+}
+
+std::vector<size_t> quickHull(const Point* pts, size_t n)
+{
+    return quickHullOf(pts, n);
+}
+
+std::vector<size_t> quickHull(const double* x, const double* y, size_t n)
+{
+    return quickHullOf(Columns<double>{ x, y }, n);
+}
+
+std::vector<size_t> quickHull(const float* x, const float* y, size_t n)
+{
+    return quickHullOf(Columns<float>{ x, y }, n);
+}
+
+std::vector<size_t> quickHull(const FloatPoint* pts, size_t n)
+{
+    return quickHullOf(pts, n);
+}
+
+std::vector<size_t> quickHull(const IntPoint* pts, size_t n)
+{
+    return quickHullOf(pts, n);
+}
+
+std::vector<size_t> quickHullChain(const Point* pts, const size_t* subset, size_t count, size_t a, size_t b)
+{
+    std::vector<Item> items(count);
+    for (size_t k = 0; k < count; k++) {
+        items[k] = { pts[subset[k]], subset[k] };
+    }
+    //a, the chain, then b, which dropFlat() reads as a closed polygon whose
+    //closing edge b->a has every chain point strictly on its convex side
+    std::vector<size_t> chain;
+    chain.push_back(a);
+    hullSegment(items.data(), 0, count, pts[a], pts[b], chain);
+    chain.push_back(b);
+    dropFlat<double>(pts, chain);
+    return std::vector<size_t>(chain.begin() + 1, chain.end() - 1);
+}
+
+std::vector<size_t> quickHullParallel(const Point* pts, size_t n, TaskPool& pool)
+{
+    if (n < parallelCutoff || pool.size() == 1) {
+        return quickHull(pts, n);
+    }
+
+    //a few chunks per thread so stealing can even out uneven chunks
+    const size_t grain = std::max<size_t>(n / (pool.size() * 8), 4096);
+    const size_t chunks = (n + grain - 1) / grain;
+
+    std::vector<size_t> mins(chunks), maxs(chunks);
+    pool.parallelFor(0, chunks, 1, [&](size_t c0, size_t c1) {
+        for (size_t c = c0; c < c1; c++) {
+            findExtremes(pts, c * grain, std::min(n, (c + 1) * grain), mins[c], maxs[c]);
+        }
+    });
+    size_t lo = mins[0], hi = maxs[0];
+    for (size_t c = 1; c < chunks; c++) {
+        if (lessXY(pts[mins[c]], pts[lo])) lo = mins[c];
+        if (lessXY(pts[hi], pts[maxs[c]])) hi = maxs[c];
+    }
+
+    std::vector<size_t> hull;
+    hull.push_back(lo);
+    if (pts[lo] == pts[hi]) {
+        return hull;
+    }
+    const Point a = pts[lo];
+    const Point b = pts[hi];
+
+    std::vector<size_t> lowerCount(chunks), upperCount(chunks);
+    pool.parallelFor(0, chunks, 1, [&](size_t c0, size_t c1) {
+        for (size_t c = c0; c < c1; c++) {
+            size_t nl = 0, nu = 0;
+            for (size_t i = c * grain; i < std::min(n, (c + 1) * grain); i++) {
+                const double o = orient2d(a, b, pts[i]);
+                if (o < 0) nl++;
+                else if (o > 0) nu++;
+            }
+            lowerCount[c] = nl;
+            upperCount[c] = nu;
+        }
+    });
+    size_t lowerTotal = 0, upperTotal = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        const size_t nl = lowerCount[c], nu = upperCount[c];
+        lowerCount[c] = lowerTotal;
+        upperCount[c] = upperTotal;
+        lowerTotal += nl;
+        upperTotal += nu;
+    }
+
+    //uninitialized on purpose, every slot that is read gets written by the scatter first
+    const size_t total = lowerTotal + upperTotal;
+    std::unique_ptr<Item[]> items(new Item[total]);
+    std::unique_ptr<Item[]> scratch(new Item[total]);
+    pool.parallelFor(0, chunks, 1, [&](size_t c0, size_t c1) {
+        for (size_t c = c0; c < c1; c++) {
+            size_t nl = lowerCount[c], nu = lowerTotal + upperCount[c];
+            for (size_t i = c * grain; i < std::min(n, (c + 1) * grain); i++) {
+                const double o = orient2d(a, b, pts[i]);
+                if (o < 0) items[nl++] = { pts[i], i };
+                else if (o > 0) items[nu++] = { pts[i], i };
+            }
+        }
+    });
+
+    ParallelHull ctx = { pool, grain };
+    std::vector<size_t> lower, upper;
+    TaskGroup group;
+    pool.spawn(group, [&] { ctx.segment(items.get(), scratch.get(), 0, lowerTotal, a, b, lower); });
+    ctx.segment(items.get(), scratch.get(), lowerTotal, total, b, a, upper);
+    pool.wait(group);
+
+    hull.insert(hull.end(), lower.begin(), lower.end());
+    hull.push_back(hi);
+    hull.insert(hull.end(), upper.begin(), upper.end());
+    dropFlat<double>(pts, hull);
+    return hull;
+}
+
+std::vector<size_t> quickHullParallel(const Point* pts, size_t n)
+{
+    return quickHullParallel(pts, n, TaskPool::shared());
+}
+
+}
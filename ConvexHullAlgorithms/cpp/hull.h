@@ -0,0 +1,78 @@
+#ifndef _HULL_H
+#define _HULL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+class TaskPool;
+
+/*Computes the convex hull of a point cloud with QuickHull
+*
+* @param pts: points to take the hull of
+* @param n: number of points
+*
+* @return indices into pts of the hull vertices in counter-clockwise order,
+*         starting at the lowest-x (then lowest-y) point. Points lying on a
+*         hull edge are not reported.
+*/
+std::vector<size_t> quickHull(const Point* pts, size_t n);
+
+/*QuickHull over separate x and y columns, such as a mapped point file,
+* same output as the Point overload
+*/
+std::vector<size_t> quickHull(const double* x, const double* y, size_t n);
+std::vector<size_t> quickHull(const float* x, const float* y, size_t n);
+
+/*QuickHull on integer or float coordinates, same output as the Point overload
+*
+* The IntPoint one does all its arithmetic exactly in 64 and 128 bits, so it
+* needs no filters and no clean-up pass, and takes 8 bytes per point instead
+* of 16. Any int32 coordinates are fine.
+*/
+std::vector<size_t> quickHull(const IntPoint* pts, size_t n);
+std::vector<size_t> quickHull(const FloatPoint* pts, size_t n);
+
+/*Multi-threaded QuickHull, same output as quickHull()
+*
+* The extreme point search and the first split run as chunked passes over
+* the input, then every sub-problem bigger than a cutoff partitions its
+* points in parallel and recurses as a stealable task. Small inputs just
+* call quickHull().
+*
+* @param pool: pool to run on, the overload without one uses TaskPool::shared()
+*/
+std::vector<size_t> quickHullParallel(const Point* pts, size_t n, TaskPool& pool);
+std::vector<size_t> quickHullParallel(const Point* pts, size_t n);
+
+/*Output-sensitive convex hull with Chan's algorithm, O(n log h)
+*
+* Guesses a hull size m, splits the input into groups of m points, hulls
+* each group and gift wraps around the group hulls for at most m steps,
+* finding the tangent to each group by binary search. A failed guess is
+* squared and tried again from the group hulls it found. The first guess is
+* 65536 and hulls its groups with quickHull(), so a group fits in cache and
+* its points go through the SIMD scans. Same output as quickHull().
+*/
+std::vector<size_t> chanHull(const Point* pts, size_t n);
+std::vector<size_t> chanHull(const double* x, const double* y, size_t n);
+std::vector<size_t> chanHull(const float* x, const float* y, size_t n);
+
+//a hull engine over a Point array, such as quickHull() or a policy's hull from dispatch.h
+typedef std::vector<size_t> (*HullFunction)(const Point* pts, size_t n);
+
+/*One chain of a hull: the vertices strictly between pts[a] and pts[b]
+*
+* @param subset: indices of the candidate points, all strictly right of a->b
+*
+* @return indices into pts in order from a to b, strictly convex with a and b
+*         like quickHull()'s output, so it can be spliced into a hull as is
+*/
+std::vector<size_t> quickHullChain(const Point* pts, const size_t* subset, size_t count, size_t a, size_t b);
+
+}
+
+#endif
@@ -0,0 +1,364 @@
+#include "kinetic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "dispatch.h"
+#include "predicates.h"
+
+namespace geom {
+
+namespace {
+
+//edits kept for takeEdits(), past this it is cheaper to read the hull again
+const size_t maxEdits = 256;
+
+//column or row of v in a grid of count cells of size from origin, clamped to the border ones
+size_t bucket(double v, double origin, double size, size_t count)
+{
+    const double f = std::floor((v - origin) / size);
+    if (!(f > 0)) {
+        return 0;
+    }
+    return f < (double)(count - 1) ? (size_t)f : count - 1;
+}
+
+}
+
+void KineticHull::build(const Point* p, size_t n, bool prefilter)
+{
+    build(p, n, prefilter ? hullFunction<Filtered<QuickHull>>() : hullFunction<QuickHull>());
+}
+
+void KineticHull::build(const Point* p, size_t n, HullFunction hullEngine)
+{
+    pts.assign(p, p + n);
+    engine = hullEngine;
+    index();
+    rebuild();
+}
+
+/*Lays a grid of about two points per cell over the bounding box of the
+* points. A box much longer than it is wide gets larger cells instead of
+* more, so there are never more than about 1.5 n.
+*/
+void KineticHull::index()
+{
+    const size_t n = pts.size();
+    Point lo = { 0, 0 }, hi = { 0, 0 };
+    if (n > 0) {
+        lo = hi = pts[0];
+    }
+    for (const Point& p : pts) {
+        lo = { std::min(lo.x, p.x), std::min(lo.y, p.y) };
+        hi = { std::max(hi.x, p.x), std::max(hi.y, p.y) };
+    }
+    const double w = hi.x - lo.x, h = hi.y - lo.y;
+    const double target = std::max(1.0, n / 2.0);
+    cellSize = std::max(std::sqrt(w * h / target), std::max(w, h) / target);
+    if (!(cellSize > 0)) {
+        cellSize = 1;
+    }
+    gridOrigin = lo;
+    gridWidth = (size_t)(w / cellSize) + 1;
+    gridHeight = (size_t)(h / cellSize) + 1;
+
+    //slack for the rounding in bucket() and in the pocket's edge clipping
+    gridMargin = 1e-9 * (std::fabs(lo.x) + std::fabs(lo.y) + w + h + cellSize);
+
+    cells.assign(gridWidth * gridHeight, std::vector<size_t>());
+    cellOf.assign(n, 0);
+    slot.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        place(i);
+    }
+}
+
+size_t KineticHull::cellAt(const Point& p) const
+{
+    return bucket(p.y, gridOrigin.y, cellSize, gridHeight) * gridWidth + bucket(p.x, gridOrigin.x, cellSize, gridWidth);
+}
+
+void KineticHull::place(size_t i)
+{
+    const size_t c = cellAt(pts[i]);
+    cellOf[i] = c;
+    slot[i] = cells[c].size();
+    cells[c].push_back(i);
+}
+
+void KineticHull::unplace(size_t i)
+{
+    std::vector<size_t>& members = cells[cellOf[i]];
+    const size_t last = members.back();
+    members[slot[i]] = last;
+    slot[last] = slot[i];
+    members.pop_back();
+}
+
+/*Appends the points other than skip strictly right of a->b. They are all
+* in the triangle a, q, b, so only the grid columns it spans are visited,
+* and in each only the rows the triangle covers within that column.
+*/
+void KineticHull::pocket(const Point& a, const Point& q, const Point& b, size_t skip, std::vector<size_t>& out) const
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const Point corner[3] = { a, q, b };
+    const double left = std::min(a.x, std::min(q.x, b.x)), right = std::max(a.x, std::max(q.x, b.x));
+    const size_t c0 = bucket(left - gridMargin, gridOrigin.x, cellSize, gridWidth);
+    const size_t c1 = bucket(right + gridMargin, gridOrigin.x, cellSize, gridWidth);
+    for (size_t cx = c0; cx <= c1; cx++) {
+        //the border columns also hold everything beyond them
+        const double s0 = cx == 0 ? -inf : gridOrigin.x + cx * cellSize - gridMargin;
+        const double s1 = cx + 1 == gridWidth ? inf : gridOrigin.x + (cx + 1) * cellSize + gridMargin;
+
+        //the triangle's y extent within the column, from its edges clipped to it
+        double low = inf, high = -inf;
+        for (int e = 0; e < 3; e++) {
+            const Point& u = corner[e];
+            const Point& v = corner[(e + 1) % 3];
+            const double l = std::max(s0, std::min(u.x, v.x)), h = std::min(s1, std::max(u.x, v.x));
+            if (l > h) {
+                continue;
+            }
+            const double ylo = std::min(u.y, v.y), yhi = std::max(u.y, v.y);
+            if (u.x == v.x) {
+                low = std::min(low, ylo);
+                high = std::max(high, yhi);
+                continue;
+            }
+            const double slope = (v.y - u.y) / (v.x - u.x);
+            for (double x : { l, h }) {
+                const double y = std::min(yhi, std::max(ylo, u.y + (x - u.x) * slope));
+                low = std::min(low, y);
+                high = std::max(high, y);
+            }
+        }
+        if (low > high) {
+            continue;
+        }
+        const size_t r0 = bucket(low - gridMargin, gridOrigin.y, cellSize, gridHeight);
+        const size_t r1 = bucket(high + gridMargin, gridOrigin.y, cellSize, gridHeight);
+        for (size_t cy = r0; cy <= r1; cy++) {
+            for (size_t j : cells[cy * gridWidth + cx]) {
+                if (j != skip && orient2d(a, b, pts[j]) < 0) {
+                    out.push_back(j);
+                }
+            }
+        }
+    }
+}
+
+void KineticHull::rebuild()
+{
+    edits.clear();
+    editChains.clear();
+    editsLost = true;
+    hull = engine(pts.data(), pts.size());
+    onHull.assign(pts.size(), 0);
+    for (size_t i : hull) {
+        onHull[i] = 1;
+    }
+}
+
+//position k such that edge k -> k+1 has p strictly on its outer side, or h if there is none
+size_t KineticHull::visibleEdge(const Point& p) const
+{
+    const size_t h = hull.size();
+    const Point& v0 = at(0);
+    if (orient2d(v0, at(1), p) < 0) {
+        return 0;
+    }
+    if (orient2d(v0, at(h - 1), p) > 0) {
+        return h - 1;
+    }
+    size_t lo = 1, hi = h - 1;
+    while (hi - lo > 1) {
+        const size_t mid = (lo + hi) / 2;
+        if (orient2d(v0, at(mid), p) >= 0) lo = mid;
+        else hi = mid;
+    }
+    return orient2d(at(lo), at(lo + 1), p) < 0 ? lo : h;
+}
+
+/*Position of hull vertex i, by binary search on the lower chain (which
+* ascends in x, y order up to the rightmost vertex) or the upper chain
+*/
+size_t KineticHull::locate(size_t i) const
+{
+    const size_t h = hull.size();
+    size_t lo = 0, hi = h - 1;
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (lessXY(at(mid), at(mid + 1))) lo = mid + 1;
+        else hi = mid;
+    }
+    const size_t peak = lo;
+
+    const Point& q = pts[i];
+    const auto byXY = [this](size_t v, const Point& p) { return lessXY(pts[v], p); };
+    const auto byYX = [this](size_t v, const Point& p) { return lessXY(p, pts[v]); };
+    size_t k;
+    if (orient2d(at(0), at(peak), q) <= 0) {
+        k = std::lower_bound(hull.begin(), hull.begin() + peak + 1, q, byXY) - hull.begin();
+    }
+    else {
+        k = std::lower_bound(hull.begin() + peak, hull.end(), q, byYX) - hull.begin();
+    }
+    if (k < h && hull[k] == i) {
+        return k;
+    }
+    return std::find(hull.begin(), hull.end(), i) - hull.begin();
+}
+
+//puts point i between hull positions from and to, dropping what it makes reflex on both sides
+void KineticHull::attach(size_t i, size_t from, size_t to)
+{
+    const Point& p = pts[i];
+    for (size_t guard = hull.size(); guard > 0 && orient2d(at(prev(from)), at(from), p) <= 0; guard--) {
+        from = prev(from);
+    }
+    for (size_t guard = hull.size(); guard > 0 && orient2d(p, at(to), at(next(to))) <= 0; guard--) {
+        to = next(to);
+    }
+    if (from == to) {
+        rebuild();
+        return;
+    }
+    splice(from, to, { i });
+}
+
+//replaces the vertices strictly between positions from and to (going forward) with chain
+void KineticHull::splice(size_t from, size_t to, const std::vector<size_t>& chain)
+{
+    for (size_t k = next(from); k != to; k = next(k)) {
+        onHull[hull[k]] = 0;
+    }
+    for (size_t v : chain) {
+        onHull[v] = 1;
+    }
+    record({ from, to, editChains.size(), chain.size(), false }, chain.data());
+    if (from < to) {
+        hull.erase(hull.begin() + from + 1, hull.begin() + to);
+        hull.insert(hull.begin() + from + 1, chain.begin(), chain.end());
+    }
+    else {
+        hull.erase(hull.begin() + from + 1, hull.end());
+        hull.erase(hull.begin(), hull.begin() + to);
+        hull.insert(hull.end(), chain.begin(), chain.end());
+    }
+}
+
+//brings the lowest-x vertex back to the front, only does work when an extreme vertex changed
+void KineticHull::normalize()
+{
+    const size_t h = hull.size();
+    if (h < 2 || (lessXY(at(0), at(1)) && lessXY(at(0), at(h - 1)))) {
+        return;
+    }
+    size_t best = 0;
+    for (size_t k = 1; k < h; k++) {
+        if (lessXY(at(k), at(best))) best = k;
+    }
+    record({ best, 0, 0, 0, true }, nullptr);
+    std::rotate(hull.begin(), hull.begin() + best, hull.end());
+}
+
+void KineticHull::record(const Edit& e, const size_t* chain)
+{
+    if (editsLost) {
+        return;
+    }
+    if (edits.size() == maxEdits) {
+        edits.clear();
+        editChains.clear();
+        editsLost = true;
+        return;
+    }
+    edits.push_back(e);
+    editChains.insert(editChains.end(), chain, chain + e.count);
+}
+
+bool KineticHull::takeEdits(std::vector<Edit>& out, std::vector<size_t>& chains)
+{
+    const bool complete = !editsLost;
+    out.swap(edits);
+    chains.swap(editChains);
+    edits.clear();
+    editChains.clear();
+    editsLost = false;
+    return complete;
+}
+
+void KineticHull::add(const Point& p)
+{
+    pts.push_back(p);
+    onHull.push_back(0);
+    cellOf.push_back(0);
+    slot.push_back(0);
+    place(pts.size() - 1);
+    if (hull.size() < 3) {
+        rebuild();
+        return;
+    }
+    const size_t e = visibleEdge(p);
+    if (e != hull.size()) {
+        attach(pts.size() - 1, e, next(e));
+        normalize();
+    }
+}
+
+void KineticHull::move(size_t i, const Point& p)
+{
+    //a vertex is found by its old position
+    const bool vertex = onHull[i] && hull.size() >= 4;
+    const size_t k = vertex ? locate(i) : 0;
+    const Point q = pts[i];
+    pts[i] = p;
+    if (cellAt(p) != cellOf[i]) {
+        unplace(i);
+        place(i);
+    }
+
+    if (hull.size() < 4) {
+        rebuild();
+        return;
+    }
+
+    if (!vertex) {
+        const size_t e = visibleEdge(p);
+        if (e != hull.size()) {
+            attach(i, e, next(e));
+            normalize();
+        }
+        return;
+    }
+
+    const size_t a = prev(k), b = next(k);
+    const Point& pa = at(a);
+    const Point& pb = at(b);
+
+    //old spot is still covered by the triangle a, p, b: nothing behind it can show up
+    if (orient2d(pa, pb, p) < 0 && orient2d(pa, p, q) >= 0 && orient2d(p, pb, q) >= 0) {
+        attach(i, a, b);
+        normalize();
+        return;
+    }
+
+    //moved inward or sideways: recompute the chain between the neighbours without i
+    std::vector<size_t> candidates;
+    pocket(pa, q, pb, i, candidates);
+    const size_t ia = hull[a], ib = hull[b];
+    splice(a, b, quickHullChain(pts.data(), candidates.data(), candidates.size(), ia, ib));
+    onHull[i] = 0;
+    normalize();
+
+    const size_t e = visibleEdge(p);
+    if (e != hull.size()) {
+        attach(i, e, next(e));
+        normalize();
+    }
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef _KINETIC_H
+#define _KINETIC_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+#include "hull.h"
+
+namespace geom {
+
+/*Convex hull that is patched, not rebuilt, when a single point moves
+*
+* Keeps its own copy of the points and the hull as indices in the same
+* order quickHull() returns them. A move is handled by case:
+*   - an interior point that stays inside: one O(log h) inside test
+*   - an interior point that leaves: the new vertex is spliced in and the
+*     vertices it can see are dropped, O(log h) plus the dropped vertices
+*   - a hull vertex moving outward: same walk from its current slot
+*   - a hull vertex moving inward: only the pocket behind its two
+*     neighbours can expose new vertices, that chain is recomputed and the
+*     point reinserted if it is still outside
+* The points that can be in the pocket lie in the triangle of the vertex's
+* old spot and its neighbours. They are found in a bucket grid of about two
+* points per cell laid over the points at build(), so the last case costs
+* the cells the triangle crosses plus the points in them, not a pass over
+* every point. That is about the triangle's length over the cell size:
+* O(n^(1/6)) for a uniform disc, up to O(sqrt n) for a long edge of a
+* uniform square, and only clustered input or points dragged far outside
+* the first bounding box, which pile up in the border cells, get near O(n).
+* Splices move the hull array, so every case also costs O(h) at worst.
+*/
+class KineticHull
+{
+public:
+    /*@param prefilter: drop the points inside the Akl-Toussaint polygon
+    *                  before every full QuickHull, see aklToussaint()
+    */
+    void build(const Point* pts, size_t n, bool prefilter = false);
+
+    /*@param engine: runs every full hull, at build() and whenever the hull
+    *               is too small to patch, in place of QuickHull
+    */
+    void build(const Point* pts, size_t n, HullFunction engine);
+
+    //point i is now at p
+    void move(size_t i, const Point& p);
+
+    //appends a new point with index size()
+    void add(const Point& p);
+
+    size_t size() const { return pts.size(); }
+    const Point& point(size_t i) const { return pts[i]; }
+
+    //hull vertex indices, counter-clockwise from the lowest-x point
+    const std::vector<size_t>& vertices() const { return hull; }
+
+    /*One change to vertices(), as the hull is patched
+    *
+    * With rotate unset the vertices strictly between positions from and to,
+    * going forward and past the end, are replaced by count indices starting
+    * at chain in takeEdits()'s chains. Where that wraps past the end, the
+    * ones before to are dropped from the front and the new ones appended.
+    * With rotate set position from moves to the front.
+    */
+    struct Edit
+    {
+        size_t from;
+        size_t to;
+        size_t chain;
+        size_t count;
+        bool   rotate;
+    };
+
+    /*Hands over the edits that turn vertices() as it was at the last call,
+    * or at build(), into what it is now, so a copy of the hull can follow it
+    * for the cost of what changed
+    *
+    * @return false if the hull was rebuilt from scratch in between or more
+    *         edits piled up than are kept, then vertices() has to be read
+    *         again. Either way the edits are forgotten.
+    */
+    bool takeEdits(std::vector<Edit>& edits, std::vector<size_t>& chains);
+
+private:
+    void   rebuild();
+    size_t visibleEdge(const Point& p) const;
+    size_t locate(size_t i) const;
+    void   attach(size_t i, size_t from, size_t to);
+    void   splice(size_t from, size_t to, const std::vector<size_t>& chain);
+    void   normalize();
+    void   record(const Edit& e, const size_t* chain);
+
+    void   index();
+    size_t cellAt(const Point& p) const;
+    void   place(size_t i);
+    void   unplace(size_t i);
+    void   pocket(const Point& a, const Point& q, const Point& b, size_t skip, std::vector<size_t>& out) const;
+
+    size_t next(size_t k) const { return k + 1 == hull.size() ? 0 : k + 1; }
+    size_t prev(size_t k) const { return k == 0 ? hull.size() - 1 : k - 1; }
+    const Point& at(size_t k) const { return pts[hull[k]]; }
+
+    std::vector<Point>  pts;
+    std::vector<size_t> hull;
+    std::vector<char>   onHull;
+    HullFunction        engine = quickHull;
+
+    //edits since the last takeEdits(), and whether there was one they can't describe
+    std::vector<Edit>   edits;
+    std::vector<size_t> editChains;
+    bool                editsLost = true;
+
+    //bucket grid, cell (x, y) is cells[y * gridWidth + x], points outside go to the border cells
+    Point                            gridOrigin = { 0, 0 };
+    double                           cellSize = 1;
+    double                           gridMargin = 0;
+    size_t                           gridWidth = 0;
+    size_t                           gridHeight = 0;
+    std::vector<std::vector<size_t>> cells;
+    std::vector<size_t>              cellOf;     //cell of each point
+    std::vector<size_t>              slot;       //its position in that cell
+};
+
+}
+
+#endif
@@ -2,16 +2,23 @@
 #include <Windowsx.h>
 #include <d2d1.h>
 
-#include <list>
-#include <memory>
+#include <algorithm>
+#include <vector>
 using namespace std;
 
 #pragma comment(lib, "d2d1")
 
 #include "basewin.h"
 #include "resource.h"
-
-int currAlgo = 0;
+#include "dispatch.h"
+#include "dynamic.h"
+#include "gjk.h"
+#include "hull.h"
+#include "kinetic.h"
+#include "minkowski.h"
+#include "pointstore.h"
+#include "slidingwindow.h"
+#include "spatialgrid.h"
 
 template <class T> void SafeRelease(T **ppT)
 {
@@ -66,14 +73,15 @@ struct MyEllipse
     }
 
     //checks if given coordinates overlap with this ellipse
+    //(x1/a)^2 + (y1/b)^2 <= 1 multiplied out and in double, so canvas-sized
+    //differences are exact and a zero radius doesn't divide by zero
     BOOL HitTest(float x, float y)
     {
-        const float a = ellipse.radiusX;
-        const float b = ellipse.radiusY;
-        const float x1 = x - ellipse.point.x;
-        const float y1 = y - ellipse.point.y;
-        const float d = ((x1 * x1) / (a * a)) + ((y1 * y1) / (b * b));
-        return d <= 1.0f;
+        const double a = ellipse.radiusX;
+        const double b = ellipse.radiusY;
+        const double x1 = (double)x - ellipse.point.x;
+        const double y1 = (double)y - ellipse.point.y;
+        return x1 * x1 * (b * b) + y1 * y1 * (a * a) <= (a * a) * (b * b);
     }
 
     D2D1_POINT_2F getPoint() {
@@ -81,150 +89,640 @@ struct MyEllipse
     }
 };
 
+//builds a drawable ellipse out of one row of a point store
+MyEllipse ellipseAt(const geom::PointStore& store, size_t i)
+{
+    MyEllipse e;
+    e.ellipse = D2D1::Ellipse(D2D1::Point2F(store.x(i), store.y(i)), store.radiusX(i), store.radiusY(i));
+    const geom::Color& c = store.color(i);
+    e.color = D2D1::ColorF(c.r, c.g, c.b, c.a);
+    return e;
+}
+
 struct Edge
 {
-    MyEllipse    ellipse1;
-    MyEllipse   ellipse2;
+    D2D1_POINT_2F   point1;
+    D2D1_POINT_2F   point2;
     D2D1_COLOR_F    color;
 
     void Draw(ID2D1RenderTarget* pRT, ID2D1SolidColorBrush* pBrush)
     {
         pBrush->SetColor(color);
-        pRT->DrawLine(ellipse1.getPoint(), ellipse2.getPoint(),  pBrush, 0.5f);
+        pRT->DrawLine(point1, point2, pBrush, 0.5f);
+    }
+
+};
+
+//replaces the entries strictly between positions from and to of a cyclic
+//array with chain, the way KineticHull splices its hull, see KineticHull::Edit
+template <class T>
+void spliceCyclic(vector<T>& v, size_t from, size_t to, const vector<T>& chain)
+{
+    if (from < to) {
+        v.erase(v.begin() + from + 1, v.begin() + to);
+        v.insert(v.begin() + from + 1, chain.begin(), chain.end());
     }
+    else {
+        v.erase(v.begin() + from + 1, v.end());
+        v.erase(v.begin(), v.begin() + to);
+        v.insert(v.end(), chain.begin(), chain.end());
+    }
+}
+
+struct Graph;
 
+/*How a graph gets its outer, one per policy type below Graph
+*
+* @param findOuter: fills graph.outer, from its own points or from graph1 and graph2
+* @param hull: the hull engine findOuter runs on the graph's points, from
+*              geom::hullFunction(), NULL for policies that don't take one
+* @param derived: whether findOuter reads graph1 and graph2 rather than the graph's points
+*/
+struct GraphAlgorithm
+{
+    void (*findOuter)(Graph& graph, Graph* graph1, Graph* graph2);
+    geom::HullFunction hull;
+    bool derived;
 };
 
+//the one GraphAlgorithm for each Policy, so graphs can compare them by address
+template <class Policy>
+const GraphAlgorithm* algorithmOf()
+{
+    static const GraphAlgorithm algorithm = { &Policy::findOuter, NULL, Policy::derived };
+    return &algorithm;
+}
+
+//the same for a Policy that hulls the graph's points with Engine, a policy from dispatch.h
+template <class Policy, class Engine>
+const GraphAlgorithm* algorithmOf()
+{
+    static const GraphAlgorithm algorithm = { &Policy::findOuter, geom::hullFunction<Engine>(), Policy::derived };
+    return &algorithm;
+}
+
 /*Struct for a graph
 * 
-* @param allEllipses: List of all ellipses in graph
-* @param outerEllipses: List of all outer ellipses
+* @param allEllipses: every point of the graph, stored by column
+* @param outer: hull vertices in counter-clockwise order
+* @param outerEllipses: handles of the outer vertices, empty when the hull is derived from other graphs
 * @param edges: List of all edges
-* 
-* @see EdgeSelection
 */
 struct Graph {
-    list<shared_ptr<MyEllipse>>             allEllipses;
-    list<shared_ptr<MyEllipse>>::iterator   allSelection;
+    geom::PointStore                allEllipses;
+    geom::PointHandle               allSelection;
 
-    list<shared_ptr<MyEllipse>>             outerEllipses;
-    list<shared_ptr<MyEllipse>>::iterator   outerSelection;
+    vector<geom::Point>             outer;
+    vector<geom::PointHandle>       outerEllipses;
 
-    list< shared_ptr<Edge >>                     edges;
-    list< shared_ptr<Edge >>::iterator   edgeSelection;
+    vector<Edge>                    edges;
 
-    shared_ptr<MyEllipse> AllSelection()
-    {
-        if (allSelection == allEllipses.end())
-        {
-            return nullptr;
-        }
-        else
-        {
-            return (*allSelection);
-        }
-    }
-    
-    shared_ptr<MyEllipse> OuterSelection()
-    {
-        if (outerSelection == outerEllipses.end())
-        {
-            return nullptr;
-        }
-        else
-        {
-            return (*outerSelection);
-        }
-    }
+    //set in setAlgo(), determines how outer is calculated, none leaves it empty
+    const GraphAlgorithm* algo = NULL;
 
-    shared_ptr<Edge> EdgeSelection()
-    {
-        if (edgeSelection == edges.end())
-        {
-            return nullptr;
-        }
-        else
-        {
-            return (*edgeSelection);
-        }
-    }
+    //last GJK simplex between graph1 and graph2, reused while points are dragged
+    geom::GjkCache gjkCache;
 
-    //set these values in setAlgo(), use to determine how points/edges are calculated
-    int algo;
+    //support searches over outer in O(log h), rebuilt with it in calculate()
+    geom::SupportMap support;
 
+    //hull of allEllipses by dense index, built with the algorithm's engine and
+    //patched on every move and insert that goes through the graph, valid while
+    //kineticPoints matches allEllipses.version(). Erasing a point renumbers
+    //the store, so it is rebuilt after one.
+    geom::KineticHull kinetic;
+    uint64_t kineticPoints = UINT64_MAX;
 
-    /*Goes through list of all ellipses and adds whiceverh ones belong to the outer edge to OuterEllipses
-    */
-    void findOuter(Graph* graph1, Graph* graph2) {
-        switch (algo) {
-            case MDIFFERENCE:
+    //outer, outerEllipses and edges are kinetic's hull, so calculate() can
+    //replay its edits on them instead of finding them again
+    bool patchable = false;
+    vector<geom::KineticHull::Edit> edits;
+    vector<size_t> editChains;
 
-                break;
+    //hull of allEllipses keyed by handle slot for the DYNAMIC button, patched
+    //on every insert, erase and move that goes through the graph, valid while
+    //dynamicPoints matches allEllipses.version()
+    geom::DynamicHull dynamic;
+    uint64_t dynamicPoints = UINT64_MAX;
 
-            case MSUM:
+    //when set, points only stay for the last 40 arrivals or 2 seconds, and
+    //the hull is the window's
+    bool windowed = false;
+    geom::SlidingWindowHull window{ 40, 2.0 };
 
-                break;
+    //when set, new points get a random radius from 5 to 30 rather than 10
+    bool sized = false;
 
-            case QHULL:
+    //outer is a curve traced finely enough to draw, not a list of hull vertices
+    bool curved = false;
 
-                break;
+    //bumped every time outer is recomputed, graphs derived from this one watch it
+    uint64_t hullVersion = 0;
 
-            case PCHULL:
+    //inputs the current outer and edges were built from, see calculate()
+    const GraphAlgorithm* builtAlgo = NULL;
+    uint64_t builtPoints = 0;
+    uint64_t builtFrom1 = 0;
+    uint64_t builtFrom2 = 0;
 
-                break;
+    //whether outer is built from graph1 and graph2 rather than from allEllipses
+    bool derived() {
+        return algo && algo->derived;
+    }
 
-            case GJK:
+    //allEllipses as one array, the layout the hull engines take
+    vector<geom::Point> storePoints() {
+        vector<geom::Point> pts(allEllipses.size());
+        for (size_t i = 0; i < pts.size(); i++) {
+            pts[i] = { allEllipses.x(i), allEllipses.y(i) };
+        }
+        return pts;
+    }
 
-                break;
+    /*Fills outer with the convex hull of allEllipses, in counter-clockwise order,
+    * only running the algorithm's engine if the points changed other than
+    * through the graph since the last time
+    */
+    void findPatchedHull() {
+        if (kineticPoints != allEllipses.version()) {
+            const vector<geom::Point> pts = storePoints();
+            kinetic.build(pts.data(), pts.size(), algo->hull);
+            kineticPoints = allEllipses.version();
+        }
+        kinetic.takeEdits(edits, editChains);
+        for (size_t i : kinetic.vertices()) {
+            outer.push_back({ allEllipses.x(i), allEllipses.y(i) });
+            outerEllipses.push_back(allEllipses.handleAt(i));
         }
+        patchable = true;
     }
 
-    /*Goes through list of all Outer ellipses and creates edges using 
+    /*Replays the kinetic hull's edits since the last calculate() on outer,
+    * outerEllipses and edges, so a drag costs the vertices it changes
+    * rather than a pass over the whole hull
+    *
+    * @return false if they can't be patched and have to be found again
     */
-    void findEdges(Graph *graph1, Graph *graph2) {
-        switch (currAlgo) {
-            switch (algo) {
-            case MDIFFERENCE:
+    bool patchHull() {
+        if (!patchable || builtAlgo != algo || kineticPoints != allEllipses.version()) {
+            return false;
+        }
+        if (!kinetic.takeEdits(edits, editChains)) {
+            return false;
+        }
+        for (const geom::KineticHull::Edit& e : edits) {
+            if (e.rotate) {
+                rotate(outer.begin(), outer.begin() + e.from, outer.end());
+                rotate(outerEllipses.begin(), outerEllipses.begin() + e.from, outerEllipses.end());
+                rotate(edges.begin(), edges.begin() + e.from, edges.end());
+                continue;
+            }
+            vector<geom::Point> points(e.count);
+            vector<geom::PointHandle> handles(e.count);
+            for (size_t k = 0; k < e.count; k++) {
+                const size_t i = editChains[e.chain + k];
+                points[k] = { allEllipses.x(i), allEllipses.y(i) };
+                handles[k] = allEllipses.handleAt(i);
+            }
+            spliceCyclic(outer, e.from, e.to, points);
+            spliceCyclic(outerEllipses, e.from, e.to, handles);
+            spliceCyclic(edges, e.from, e.to, vector<Edge>(e.count));
+
+            //the edge out of the vertex before the chain changes as well
+            const size_t first = e.from < e.to ? e.from : e.from - e.to;
+            for (size_t k = 0; k <= e.count; k++) {
+                const size_t j = (first + k) % outer.size();
+                edges[j] = edgeAt(j);
+            }
+        }
+        //kinetic rebuilds rather than patch a hull this small, but a 2 point
+        //hull has a single edge and would need one
+        if (outer.size() < 3) {
+            findEdges();
+        }
+        return true;
+    }
 
-                break;
+    //the same from the dynamic hull, which never runs an engine
+    void findDynamicHull() {
+        if (dynamicPoints != allEllipses.version()) {
+            const vector<geom::Point> pts = storePoints();
+            vector<size_t> slots(pts.size());
+            for (size_t i = 0; i < slots.size(); i++) {
+                slots[i] = allEllipses.handleAt(i).slot;
+            }
+            dynamic.build(pts.data(), slots.data(), pts.size());
+            dynamicPoints = allEllipses.version();
+        }
+        for (size_t slot : dynamic.vertices()) {
+            const geom::PointHandle h = allEllipses.handleAtSlot((uint32_t)slot);
+            const size_t i = allEllipses.indexOf(h);
+            outer.push_back({ allEllipses.x(i), allEllipses.y(i) });
+            outerEllipses.push_back(h);
+        }
+    }
 
-            case MSUM:
+    /*Adds a point and patches the graph's hull for it instead of invalidating
+    * it, a windowed graph drops the points that fall out of its window
+    */
+    geom::PointHandle insertPoint(float x, float y, float radiusX, float radiusY, const geom::Color& color) {
+        if (windowed) {
+            const geom::PointHandle h = allEllipses.insert(x, y, radiusX, radiusY, color);
+            vector<size_t> evicted;
+            window.push({ x, y }, GetTickCount64() / 1000.0, h.slot, &evicted);
+            for (size_t slot : evicted) {
+                allEllipses.erase(allEllipses.handleAtSlot((uint32_t)slot));
+            }
+            return h;
+        }
+        const bool kineticSynced = kineticPoints == allEllipses.version();
+        const bool dynamicSynced = dynamicPoints == allEllipses.version();
+        const geom::PointHandle h = allEllipses.insert(x, y, radiusX, radiusY, color);
+        if (kineticSynced) {
+            kinetic.add({ x, y });
+            kineticPoints = allEllipses.version();
+        }
+        if (dynamicSynced) {
+            dynamic.insert({ x, y }, h.slot);
+            dynamicPoints = allEllipses.version();
+        }
+        return h;
+    }
 
-                break;
+    //only the dynamic hull follows an erase, the kinetic one is rebuilt
+    void erasePoint(geom::PointHandle h) {
+        const size_t i = allEllipses.indexOf(h);
+        const bool synced = dynamicPoints == allEllipses.version();
+        if (synced) {
+            dynamic.erase({ allEllipses.x(i), allEllipses.y(i) }, h.slot);
+        }
+        allEllipses.erase(h);
+        if (synced) {
+            dynamicPoints = allEllipses.version();
+        }
+    }
 
-            case QHULL:
+    void movePoint(geom::PointHandle h, float x, float y) {
+        const size_t i = allEllipses.indexOf(h);
+        const bool kineticSynced = kineticPoints == allEllipses.version();
+        const bool dynamicSynced = dynamicPoints == allEllipses.version();
+        if (kineticSynced) {
+            kinetic.move(i, { x, y });
+        }
+        if (dynamicSynced) {
+            dynamic.move({ allEllipses.x(i), allEllipses.y(i) }, { x, y }, h.slot);
+        }
+        allEllipses.move(i, x, y);
+        if (kineticSynced) {
+            kineticPoints = allEllipses.version();
+        }
+        if (dynamicSynced) {
+            dynamicPoints = allEllipses.version();
+        }
+    }
+
+    /*Sets the hull to points that are not in allEllipses, for graphs whose
+    * hull is derived from other graphs
+    */
+    void setOuter(const vector<geom::Point>& pts) {
+        outer = pts;
+        outerEllipses.clear();
+        curved = false;
+    }
 
-                break;
+    void setCurve(const vector<geom::Point>& pts) {
+        setOuter(pts);
+        curved = true;
+    }
 
-            case PCHULL:
+    //recomputes outer with the graph's algorithm
+    void findOuter(Graph* graph1, Graph* graph2) {
+        outer.clear();
+        outerEllipses.clear();
+        curved = false;
+        patchable = false;
+        if (algo) {
+            algo->findOuter(*this, graph1, graph2);
+        }
+    }
 
-                break;
+    //color of hull vertex i, derived vertices don't have one of their own
+    D2D1_COLOR_F outerColor(size_t i) {
+        if (outerEllipses.empty()) {
+            return D2D1::ColorF(D2D1::ColorF::Orange);
+        }
+        const geom::Color& c = allEllipses.color(allEllipses.indexOf(outerEllipses[i]));
+        return D2D1::ColorF(c.r, c.g, c.b, c.a);
+    }
 
-            case GJK:
+    //edge from hull vertex i to the next one
+    Edge edgeAt(size_t i) {
+        const geom::Point& p1 = outer[i];
+        const geom::Point& p2 = outer[(i + 1) % outer.size()];
+        Edge edge;
+        edge.point1 = D2D1::Point2F((float)p1.x, (float)p1.y);
+        edge.point2 = D2D1::Point2F((float)p2.x, (float)p2.y);
+        edge.color = outerColor(i);
+        return edge;
+    }
 
-                break;
-            }
+    /*Goes through the outer points and connects each one to the next,
+    * outer is already in hull order for every algorithm
+    */
+    void findEdges() {
+        edges.clear();
+        if (outer.size() < 2) {
+            return;
+        }
+        //a 2 point hull is a single segment, don't draw it twice
+        const size_t count = outer.size() == 2 ? 1 : outer.size();
+        for (size_t i = 0; i < count; i++) {
+            edges.push_back(edgeAt(i));
         }
     }
 
     /*For Graph1: graph1 = graph2; graph2 = graph3
     * For Graph2: graph1 = graph1; graph2 = graph3
     * For Graph3: graph1 = graph1; graph2 = graph2
+    *
+    * Does nothing unless the points, the algorithm or (for derived graphs)
+    * the hulls of graph1 and graph2 changed since the last time, so repaints
+    * from resizing or uncovering the window are free.
     */
     void calculate(Graph *graph1, Graph *graph2) {
-        findOuter(graph1, graph2);
-        findEdges(graph1, graph2);
+        const uint64_t from1 = derived() ? graph1->hullVersion : 0;
+        const uint64_t from2 = derived() ? graph2->hullVersion : 0;
+        if (algo == builtAlgo && allEllipses.version() == builtPoints &&
+            from1 == builtFrom1 && from2 == builtFrom2) {
+            return;
+        }
 
+        if (algo != builtAlgo || !patchHull()) {
+            findOuter(graph1, graph2);
+            findEdges();
+        }
+        support.build(outer.data(), outer.size());
+
+        hullVersion++;
+        builtAlgo = algo;
+        builtPoints = allEllipses.version();
+        builtFrom1 = from1;
+        builtFrom2 = from2;
     }
 
     void clear() {
         allEllipses.clear();
+        outer.clear();
         outerEllipses.clear();
         edges.clear();
+        curved = false;
+        patchable = false;
+        gjkCache = geom::GjkCache();
+        support = geom::SupportMap();
+        window.clear();
+        builtAlgo = NULL;
+        hullVersion++;
     }
 
 };
 
+//Graph algorithms, see GraphAlgorithm
+
+/*The algorithm's engine on the graph's points, run once and then patched
+* by a KineticHull as points are dragged or added, see Graph::kinetic
+*/
+struct PatchedHull
+{
+    static const bool derived = false;
+
+    static void findOuter(Graph& graph, Graph*, Graph*) {
+        graph.findPatchedHull();
+    }
+};
+
+//the graph's dynamic hull, patched point by point as points are added,
+//removed and dragged
+struct IncrementalHull
+{
+    static const bool derived = false;
+
+    static void findOuter(Graph& graph, Graph*, Graph*) {
+        graph.findDynamicHull();
+    }
+};
+
+//the hull of the graph's sliding window, see Graph::windowed
+struct SlidingWindow
+{
+    static const bool derived = false;
+
+    static void findOuter(Graph& graph, Graph*, Graph*) {
+        const vector<size_t>& ids = graph.window.vertices();
+        const vector<geom::Point>& pts = graph.window.vertexPoints();
+        for (size_t k = 0; k < ids.size(); k++) {
+            graph.outer.push_back(pts[k]);
+            graph.outerEllipses.push_back(graph.allEllipses.handleAtSlot((uint32_t)ids[k]));
+        }
+    }
+};
+
+//the algorithm's engine run from scratch on every change, no incremental
+//patching, so it can be compared with a graph that patches its hull
+struct FromScratch
+{
+    static const bool derived = false;
+
+    static void findOuter(Graph& graph, Graph*, Graph*) {
+        const vector<geom::Point> pts = graph.storePoints();
+        const vector<size_t> hull = graph.algo->hull(pts.data(), pts.size());
+        for (size_t i : hull) {
+            graph.outer.push_back(pts[i]);
+            graph.outerEllipses.push_back(graph.allEllipses.handleAt(i));
+        }
+    }
+};
+
+//graph1 and graph2 are calculated first in OnPaint, so the hulls the derived
+//algorithms read are current
+
+struct MinkowskiSum
+{
+    static const bool derived = true;
+
+    static void findOuter(Graph& graph, Graph* graph1, Graph* graph2) {
+        const vector<geom::Point>& a = graph1->outer;
+        const vector<geom::Point>& b = graph2->outer;
+        graph.setOuter(geom::minkowskiSum(a.data(), a.size(), b.data(), b.size()));
+    }
+};
+
+/*graph1 - graph2, moved by the average of graph2's hull vertices so it sits
+* on screen: it is where that point of graph2 can be with graph2 touching
+* graph1, and holds it exactly while the two overlap
+*/
+struct MinkowskiDifference
+{
+    static const bool derived = true;
+
+    static void findOuter(Graph& graph, Graph* graph1, Graph* graph2) {
+        const vector<geom::Point>& a = graph1->outer;
+        const vector<geom::Point>& b = graph2->outer;
+        if (a.empty() || b.empty()) {
+            return;
+        }
+        geom::Point center = { 0, 0 };
+        for (const geom::Point& p : b) {
+            center = center + p;
+        }
+        center = (1.0 / b.size()) * center;
+        vector<geom::Point> difference = geom::minkowskiDifference(a.data(), a.size(), b.data(), b.size());
+        for (geom::Point& p : difference) {
+            p = p + center;
+        }
+        graph.setOuter(difference);
+    }
+};
+
+/*outer is the closest pair of points, or while the hulls overlap the two
+* contact points EPA finds, which are the penetration depth apart
+*/
+struct ClosestPair
+{
+    static const bool derived = true;
+
+    static void findOuter(Graph& graph, Graph* graph1, Graph* graph2) {
+        if (graph1->support.empty() || graph2->support.empty()) {
+            return;
+        }
+        const geom::EpaResult r = geom::epa(graph1->support, graph2->support, &graph.gjkCache);
+        graph.setOuter({ r.pointA, r.pointB });
+    }
+};
+
+/*graph2's hull where it first touches graph1, flying at graph1's center
+* over one unit of time and turning a quarter turn on the way, or where it
+* ends up if it misses. graph1 stands still.
+*/
+struct TimeOfImpact
+{
+    static const bool derived = true;
+
+    static void findOuter(Graph& graph, Graph* graph1, Graph* graph2) {
+        const geom::SupportMap& a = graph1->support;
+        const geom::SupportMap& b = graph2->support;
+        if (a.empty() || b.empty()) {
+            return;
+        }
+        geom::Motion still, flight;
+        flight.center = average(b);
+        flight.velocity = average(a) - flight.center;
+        flight.angularVelocity = 1.5707963267948966;
+        const geom::ToiResult r = geom::timeOfImpact(a, still, b, flight, 1.0, 0.5, &graph.gjkCache);
+        vector<geom::Point> moved(b.points(), b.points() + b.size());
+        for (geom::Point& p : moved) {
+            p = flight.at(p, r.time);
+        }
+        graph.setOuter(moved);
+    }
+
+    static geom::Point average(const geom::SupportMap& map) {
+        geom::Point sum = { 0, 0 };
+        for (size_t i = 0; i < map.size(); i++) {
+            sum = sum + map.points()[i];
+        }
+        return (1.0 / map.size()) * sum;
+    }
+};
+
+/*The hull of graph1's circles, radii included: arcs of the circles on it
+* joined by the segments tangent to two of them, traced to a quarter DIP
+*/
+struct DiscHullOf
+{
+    static const bool derived = true;
+
+    static void findOuter(Graph& graph, Graph* graph1, Graph*) {
+        const geom::PointStore& store = graph1->allEllipses;
+        vector<geom::Disc> discs(store.size());
+        for (size_t i = 0; i < discs.size(); i++) {
+            discs[i] = { { store.x(i), store.y(i) }, (std::max)(store.radiusX(i), store.radiusY(i)) };
+        }
+        graph.setCurve(geom::DiscHull(discs.data(), discs.size()).outline(0.25));
+    }
+};
+
+/*One of the algorithm buttons
+*
+* @param command: button id, sent with WM_COMMAND
+* @param label: button text
+* @param algo: what graph1, graph2 and graph3 run, NULL for an unused graph
+* @param seeded: which graphs start with random points of their own
+* @param streamed: graph1 is windowed and a timer keeps adding points to it
+* @param sized: graph1's points get random radii
+*/
+struct AlgorithmButton
+{
+    int                     command;
+    LPCWSTR                 label;
+    const GraphAlgorithm*   algo[3];
+    bool                    seeded[3];
+    bool                    streamed;
+    bool                    sized;
+};
+
+//how the buttons hull a graph's own points
+const GraphAlgorithm* const quickHullGraph = algorithmOf<PatchedHull, geom::Filtered<geom::QuickHull>>();
+
+const AlgorithmButton algorithmButtons[] = {
+    //graph3 has no points of its own, it is graph1 - graph2
+    { MDIFFERENCE, L"MDIF",
+      { quickHullGraph, quickHullGraph, algorithmOf<MinkowskiDifference>() },
+      { true, true, false }, false, false },
+    //graph3 has no points of its own, it is the sum of the other two
+    { MSUM, L"MSUM",
+      { quickHullGraph, quickHullGraph, algorithmOf<MinkowskiSum>() },
+      { true, true, false }, false, false },
+    { QHULL, L"QH",
+      { quickHullGraph, NULL, NULL },
+      { true, false, false }, false, false },
+    { PCHULL, L"PCH",
+      { quickHullGraph, algorithmOf<FromScratch, geom::Filtered<geom::ChanHull>>(), NULL },
+      { true, true, false }, false, false },
+    //graph3 is the closest pair between the hulls of graph1 and graph2, or
+    //their contact points while they overlap
+    { GJK, L"GJK",
+      { quickHullGraph, quickHullGraph, algorithmOf<ClosestPair>() },
+      { true, true, false }, false, false },
+    //graph1 is the hull of a live stream of points, only the latest ones count
+    { WINDOW, L"WIN",
+      { algorithmOf<SlidingWindow>(), NULL, NULL },
+      { false, false, false }, true, false },
+    //graph3 is graph2 stopped where it first hits graph1 on its way across
+    { IMPACT, L"TOI",
+      { quickHullGraph, quickHullGraph, algorithmOf<TimeOfImpact>() },
+      { true, true, false }, false, false },
+    //graph3 is the hull of graph1's circles of all sizes, graph1 the hull of their centers
+    { DISCS, L"DISC",
+      { quickHullGraph, NULL, algorithmOf<DiscHullOf>() },
+      { true, false, false }, false, true },
+    //graph1 keeps its hull in a DynamicHull, so points can be erased as well
+    //as added and dragged without the hull ever being rebuilt
+    { DYNAMIC, L"DYN",
+      { algorithmOf<IncrementalHull>(), NULL, NULL },
+      { true, false, false }, false, false },
+};
+
+//the button with the given command id, NULL if there is none
+const AlgorithmButton* findAlgorithmButton(int command)
+{
+    for (const AlgorithmButton& b : algorithmButtons) {
+        if (b.command == command) {
+            return &b;
+        }
+    }
+    return NULL;
+}
+
 D2D1::ColorF::Enum colors[] = { D2D1::ColorF::LimeGreen };
 
 
@@ -247,54 +745,46 @@ class MainWindow : public BaseWindow<MainWindow>
     Mode                    mode;
     size_t                  nextColor;
 
-    //draw lists, everything in these will be drawn
-    list<shared_ptr<MyEllipse>>             ellipses;
-    list<shared_ptr<MyEllipse>>::iterator   selection;
-
-    list< shared_ptr<Edge >>                     edges;
-    list< shared_ptr<Edge >>::iterator   edgeSelection;
-
-    //graphs to be used
+    //graphs to be used, drawn in this order
     Graph graph1;
     Graph graph2;
     Graph graph3;
     Graph convexGraph;
 
+    //selected point, a handle stays valid while other points are added
+    Graph*                  selectionGraph;
+    geom::PointHandle       selection;
+    uint64_t                selectionPickId;
 
-     
-    shared_ptr<MyEllipse> Selection() 
-    { 
-        if (selection == ellipses.end()) 
-        { 
-            return nullptr;
-        }
-        else
-        {
-            return (*selection);
-        }
+    //every point of every graph by position, grid ids index pickPoints
+    geom::SpatialGrid                           pickGrid;
+    vector<pair<Graph*, geom::PointHandle>>     pickPoints;
+
+    BOOL Selection()
+    {
+        return selectionGraph && selectionGraph->allEllipses.contains(selection);
     }
 
-    shared_ptr<Edge> EdgeSelection()
+    D2D1_POINT_2F SelectionPoint()
     {
-        if (edgeSelection == edges.end())
-        {
-            return nullptr;
-        }
-        else
-        {
-            return (*edgeSelection);
-        }
+        const geom::PointStore& store = selectionGraph->allEllipses;
+        const size_t i = store.indexOf(selection);
+        return D2D1::Point2F(store.x(i), store.y(i));
     }
 
-    void    ClearSelection() { selection = ellipses.end(); }
+    void    MoveSelectionTo(float x, float y)
+    {
+        selectionGraph->movePoint(selection, x, y);
+        pickGrid.move(selectionPickId, x, y);
+    }
+
+    void    ClearSelection() { selectionGraph = NULL; selection = geom::PointHandle(); }
     HRESULT InsertEllipse(float x, float y);
-    void fillDraw(Graph* graph);
-    HRESULT InsertEdge(MyEllipse p1, MyEllipse p2);
     HRESULT InsertEllipseGraph(Graph* graph, float x, float y);
+    void    AddPickPoint(Graph* graph, geom::PointHandle h);
 
     BOOL    HitTest(float x, float y);
     void    SetMode(Mode m);
-    void    checkEdges(shared_ptr<MyEllipse>);
     void    createPoint(Graph* graph);
     void    MoveSelection(float x, float y);
     HRESULT CreateGraphicsResources();
@@ -309,7 +799,7 @@ class MainWindow : public BaseWindow<MainWindow>
 public:
 
     MainWindow() : pFactory(NULL), pRenderTarget(NULL), pBrush(NULL), 
-        ptMouse(D2D1::Point2F()), nextColor(0), selection(ellipses.end())
+        ptMouse(D2D1::Point2F()), nextColor(0), selectionGraph(NULL), selectionPickId(0)
     {
     }
 
@@ -348,20 +838,6 @@ void MainWindow::DiscardGraphicsResources()
     SafeRelease(&pBrush);
 }
 
-/*Adds all edges and ellipses of a graph to drawing ellipses and edges
-* 
-* @param Graph: pointer to graph whose ellipses and edges are being added
-*/
-void MainWindow::fillDraw(Graph* graph) {
-    for (shared_ptr<MyEllipse> p : graph->allEllipses) {
-        selection = ellipses.insert(ellipses.end(), 1, p);
-    }
-    for (shared_ptr<Edge> p : graph->edges) {
-        edgeSelection = edges.insert(edges.end(), 1, p);
-    }
-    
-}
-
 //tells D2D1 what needs to been drawn
 void MainWindow::OnPaint()
 {
@@ -379,14 +855,35 @@ void MainWindow::OnPaint()
 
         pRenderTarget->Clear( D2D1::ColorF(D2D1::ColorF::SkyBlue) );
 
-        for (auto i = ellipses.begin(); i != ellipses.end(); ++i)
+        //points are drawn in store order, so the stacking of overlapping points
+        //is not stable: erasing a point moves the graph's last point into its
+        //place and draws it under the ones after it. HitTest() follows it.
+        for (Graph* graph : { &graph1, &graph2, &graph3 })
         {
-            (*i)->Draw(pRenderTarget, pBrush);
+            for (size_t i = 0; i < graph->allEllipses.size(); ++i)
+            {
+                ellipseAt(graph->allEllipses, i).Draw(pRenderTarget, pBrush);
+            }
         }
 
-        for (auto i = edges.begin(); i != edges.end(); ++i)
+        for (Graph* graph : { &graph1, &graph2, &graph3 })
         {
-            (*i)->Draw(pRenderTarget, pBrush);
+            for (Edge& edge : graph->edges)
+            {
+                edge.Draw(pRenderTarget, pBrush);
+            }
+
+            //derived hulls have no points of their own, mark their vertices
+            if (graph->outerEllipses.empty() && !graph->curved)
+            {
+                for (size_t i = 0; i < graph->outer.size(); ++i)
+                {
+                    MyEllipse vertex;
+                    vertex.ellipse = D2D1::Ellipse(D2D1::Point2F((float)graph->outer[i].x, (float)graph->outer[i].y), 5.0f, 5.0f);
+                    vertex.color = graph->outerColor(i);
+                    vertex.Draw(pRenderTarget, pBrush);
+                }
+            }
         }
 
         /*
@@ -436,7 +933,17 @@ void MainWindow::OnLButtonDown(int pixelX, int pixelY, DWORD flags)
 
     if (mode == DrawMode)
     {
-     
+        //clicking a point removes it, clicking anywhere else adds one to the first graph
+        if (HitTest(dipX, dipY))
+        {
+            pickGrid.remove(selectionPickId);
+            selectionGraph->erasePoint(selection);
+            ClearSelection();
+        }
+        else
+        {
+            InsertEllipse(dipX, dipY);
+        }
     }
     else
     {
@@ -446,7 +953,7 @@ void MainWindow::OnLButtonDown(int pixelX, int pixelY, DWORD flags)
         {
             SetCapture(m_hwnd);
 
-            ptMouse = Selection()->ellipse.point;
+            ptMouse = SelectionPoint();
             ptMouse.x -= dipX;
             ptMouse.y -= dipY;
 
@@ -482,64 +989,23 @@ void MainWindow::OnMouseMove(int pixelX, int pixelY, DWORD flags)
         if (mode == DragMode)
         {
             // Move the ellipse.
-            Selection()->ellipse.point.x = dipX + ptMouse.x;
-            Selection()->ellipse.point.y = dipY + ptMouse.y;
+            MoveSelectionTo(dipX + ptMouse.x, dipY + ptMouse.y);
         }
         InvalidateRect(m_hwnd, NULL, FALSE);
     }
 }
 
-
-
-//this function checks all ellipses and inserts an edge if one is valid
-void MainWindow::checkEdges(shared_ptr<MyEllipse> curr) {
-    for (auto i = ellipses.rbegin(); i != ellipses.rend(); ++i) {
-        if (*i != curr) {
-            switch (currAlgo) {
-            case MDIFFERENCE:
-
-                break;
-
-            case MSUM:
-
-                break;
-
-            case QHULL:
-
-                break;
-
-            case PCHULL:
-
-                break;
-
-            case GJK:
-
-                break;
-            }
-        }
-    }
-}
-
-//adds ellipse to draw list
+//adds ellipse to the first graph and selects it
 HRESULT MainWindow::InsertEllipse(float x, float y)
 {
-    try
+    HRESULT hr = InsertEllipseGraph(&graph1, x, y);
+    if (SUCCEEDED(hr) && !graph1.windowed)
     {
-        selection = ellipses.insert(
-            ellipses.end(), 
-            shared_ptr<MyEllipse>(new MyEllipse()));
-
-        Selection()->ellipse.point = ptMouse = D2D1::Point2F(x, y);
-        Selection()->ellipse.radiusX = Selection()->ellipse.radiusY = 10.0f;
-        Selection()->color = D2D1::ColorF( colors[nextColor] );
-        checkEdges(Selection());
-        nextColor = (nextColor + 1) % ARRAYSIZE(colors);
+        selectionGraph = &graph1;
+        selection = graph1.allSelection;
+        selectionPickId = pickPoints.size() - 1;
     }
-    catch (std::bad_alloc)
-    {
-        return E_OUTOFMEMORY;
-    }
-    return S_OK;
+    return hr;
 }
 
 /*inserts ellipse into a specific graph
@@ -552,13 +1018,12 @@ HRESULT MainWindow::InsertEllipseGraph(Graph *graph, float x, float y)
 {
     try
     {
-        graph->allSelection = graph->allEllipses.insert(
-            graph->allEllipses.end(),
-            shared_ptr<MyEllipse>(new MyEllipse()));
-
-        graph->AllSelection()->ellipse.point = ptMouse = D2D1::Point2F(x, y);
-        graph->AllSelection()->ellipse.radiusX = graph->AllSelection()->ellipse.radiusY = 10.0f;
-        graph->AllSelection()->color = D2D1::ColorF(colors[nextColor]);
+        const D2D1_COLOR_F color = D2D1::ColorF(colors[nextColor]);
+        const float radius = graph->sized ? 5.0f + 25.0f * ((float)rand() / RAND_MAX) : 10.0f;
+        graph->allSelection = graph->insertPoint(
+            x, y, radius, radius, { color.r, color.g, color.b, color.a });
+        AddPickPoint(graph, graph->allSelection);
+        ptMouse = D2D1::Point2F(x, y);
         nextColor = (nextColor + 1) % ARRAYSIZE(colors);
 
     }
@@ -569,47 +1034,56 @@ HRESULT MainWindow::InsertEllipseGraph(Graph *graph, float x, float y)
     return S_OK;
 }
 
-//takes 2 ellipses and adds an edge into the draw list
-HRESULT MainWindow::InsertEdge(MyEllipse p1, MyEllipse p2)
+//adds a point to the picking grid
+void MainWindow::AddPickPoint(Graph* graph, geom::PointHandle h)
 {
-    try
+    //windowed points come and go on their own, they can't be picked
+    if (graph->windowed)
     {
-        edgeSelection = edges.insert(
-            edges.end(),
-            shared_ptr<Edge>(new Edge()));
-
-        EdgeSelection()->ellipse1 = p1;
-        EdgeSelection()->ellipse2 = p2;
-        EdgeSelection()->color = D2D1::ColorF(colors[nextColor]);
-        nextColor = (nextColor + 1) % ARRAYSIZE(colors);
+        return;
     }
-    catch (std::bad_alloc)
-    {
-        return E_OUTOFMEMORY;
-    }
-    return S_OK;
+    const geom::PointStore& store = graph->allEllipses;
+    const size_t i = store.indexOf(h);
+    const uint64_t id = pickPoints.size();
+    pickPoints.push_back(make_pair(graph, h));
+    pickGrid.insert(id, store.x(i), store.y(i), (std::max)(store.radiusX(i), store.radiusY(i)));
 }
 
-//runs ellipse hittest function on all dots
+/*runs ellipse hittest function on the dots near (x, y), topmost first
+* z-order matches OnPaint: later graphs are drawn over earlier ones and
+* within a graph points are drawn in store order, which an erase changes
+* by moving the last point into the hole, so it is read at pick time
+*/
 BOOL MainWindow::HitTest(float x, float y)
 {
-    for (auto i = ellipses.rbegin(); i != ellipses.rend(); ++i)
+    uint64_t id;
+    BOOL hit = pickGrid.pick(x, y, [&](uint64_t candidate) {
+        const pair<Graph*, geom::PointHandle>& p = pickPoints[candidate];
+        const geom::PointStore& store = p.first->allEllipses;
+        return store.contains(p.second) && ellipseAt(store, store.indexOf(p.second)).HitTest(x, y);
+    }, [&](uint64_t candidate) {
+        const pair<Graph*, geom::PointHandle>& p = pickPoints[candidate];
+        const geom::PointStore& store = p.first->allEllipses;
+        const uint64_t layer = p.first == &graph1 ? 0 : p.first == &graph2 ? 1 : 2;
+        const uint64_t index = store.contains(p.second) ? store.indexOf(p.second) : 0;
+        return (layer << 40) | index;
+    }, id);
+
+    if (hit)
     {
-        if ((*i)->HitTest(x, y))
-        {
-            selection = (++i).base();
-            return TRUE;
-        }
+        selectionGraph = pickPoints[id].first;
+        selection = pickPoints[id].second;
+        selectionPickId = id;
     }
-    return FALSE;
+    return hit;
 }
 
 void MainWindow::MoveSelection(float x, float y)
 {
     if ((mode == SelectMode) && Selection())
     {
-        Selection()->ellipse.point.x += x;
-        Selection()->ellipse.point.y += y;
+        const D2D1_POINT_2F pt = SelectionPoint();
+        MoveSelectionTo(pt.x + x, pt.y + y);
         InvalidateRect(m_hwnd, NULL, FALSE);
     }
 }
@@ -637,51 +1111,25 @@ void MainWindow::SetMode(Mode m)
     hCursor = LoadCursor(NULL, cursor);
     SetCursor(hCursor);
 }
-HWND CreateButton(HWND m_hWnd, int algo) {
+HWND CreateButton(HWND m_hWnd, const AlgorithmButton& button) {
     HFONT hFont = CreateFont(8, 0, 0, 0, FW_DONTCARE, FALSE, FALSE, FALSE, ANSI_CHARSET,
         OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY,
         DEFAULT_PITCH | FF_DONTCARE, TEXT("Tahoma"));
-    LPCWSTR text;
-    switch (algo) {
-    case MDIFFERENCE:
-        text = L"MDIF";
-        break;
-
-    case MSUM:
-        text = L"MSUM";
-        break;
-
-    case QHULL:
-        text = L"QH";
-        break;
-
-    case PCHULL:
-        text = L"PCH";
-        break;
-
-    case GJK:
-        text = L"GJK";
-        break;
-
-    default:
-        text = L"err";
-        break;
-    }
 
     HWND hwnd = CreateWindowEx(
         0,                              // Optional window styles.
         L"BUTTON",                     // Window class
-        text,    // Window text
+        button.label,    // Window text
         WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_DEFPUSHBUTTON,           // Window style
 
         // Size and position
         0,         // x position 
-        50 + algo,         // y position 
+        50 + button.command,         // y position 
         50,        // Button width
         50,        // Button height
 
         m_hWnd,       // Parent window   
-        (HMENU)algo,
+        (HMENU)button.command,
         (HINSTANCE)GetWindowLongPtr(m_hWnd, GWLP_HINSTANCE),
         NULL        // Additional application data
     );
@@ -700,11 +1148,9 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR, int nCmdShow)
 
     HACCEL hAccel = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDR_ACCEL1));
 
-    CreateButton(win.Window(), MDIFFERENCE);
-    CreateButton(win.Window(), MSUM);
-    CreateButton(win.Window(), QHULL);
-    CreateButton(win.Window(), PCHULL);
-    CreateButton(win.Window(), GJK);
+    for (const AlgorithmButton& button : algorithmButtons) {
+        CreateButton(win.Window(), button);
+    }
     ShowWindow(win.Window(), nCmdShow);
 
     MSG msg;
@@ -731,60 +1177,35 @@ void MainWindow::createPoint(Graph* graph) {
 
 //Occurs when button is pressed, resets dots and changes alogrithm
  void MainWindow::setAlgo(int algo) {
-    currAlgo = algo;
-    ellipses.clear();
-    edges.clear();
+    const AlgorithmButton* button = findAlgorithmButton(algo);
+    if (!button) {
+        return;
+    }
+    ClearSelection();
+    pickGrid.clear();
+    pickPoints.clear();
     graph1.clear();
     graph2.clear();
     graph3.clear();
     DiscardGraphicsResources();
 
+    Graph* graphs[3] = { &graph1, &graph2, &graph3 };
+    for (int g = 0; g < 3; g++) {
+        graphs[g]->algo = button->algo[g];
+    }
+    graph1.windowed = button->streamed;
+    graph1.sized = button->sized;
+    KillTimer(m_hwnd, STREAM_TIMER);
+    if (button->streamed) {
+        SetTimer(m_hwnd, STREAM_TIMER, 50, NULL);
+    }
     for (int i = 0; i < 5; i++) {
-        switch (currAlgo) {
-            case MDIFFERENCE:
-                graph1.algo = QHULL;
-                createPoint(&graph1);
-                graph2.algo = QHULL;
-                createPoint(&graph2);
-                graph3.algo = MDIFFERENCE;
-                createPoint(&graph3);
-                break;
-
-            case MSUM:
-                graph1.algo = QHULL;
-                createPoint(&graph1);
-                graph2.algo = QHULL;
-                createPoint(&graph2);
-                graph3.algo = MSUM;
-                createPoint(&graph3);
-                break;
-
-            case QHULL:
-                graph1.algo = QHULL;
-                createPoint(&graph1);
-                break;
-
-            case PCHULL:
-                graph1.algo = QHULL;
-                createPoint(&graph1);
-                graph2.algo = PCHULL;
-                createPoint(&graph2);
-                break;
-
-            case GJK:
-                //IDK TODO
-                createPoint(&graph1);
-                break;
-
-            default:
-                createPoint(&graph1);
-                break;
-        }
-    }
-    fillDraw(&graph1);
-    fillDraw(&graph2);
-    fillDraw(&graph3);
-  
+        for (int g = 0; g < 3; g++) {
+            if (button->seeded[g]) {
+                createPoint(graphs[g]);
+            }
+        }
+    }
 
     InvalidateRect(m_hwnd, NULL, FALSE);
 }
@@ -840,32 +1261,25 @@ LRESULT MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
     case WM_KEYDOWN:
         return 0;
 
+    case WM_TIMER:
+        if (wParam == STREAM_TIMER)
+        {
+            createPoint(&graph1);
+            InvalidateRect(m_hwnd, NULL, FALSE);
+        }
+        return 0;
+
     case WM_SETFONT:
 
 
     case WM_COMMAND:
+        if (findAlgorithmButton(LOWORD(wParam)))
+        {
+            setAlgo(LOWORD(wParam));
+            return 0;
+        }
         switch (LOWORD(wParam))
         {
-        case MDIFFERENCE:
-            setAlgo( MDIFFERENCE);
-            break;
-
-        case MSUM:
-            setAlgo(MSUM);
-            break;
-
-        case QHULL:
-            setAlgo (QHULL);
-            break;
-
-        case PCHULL:
-            setAlgo( PCHULL);
-            break;
-
-        case GJK:
-            setAlgo( GJK);
-            break;
-
         case ID_DRAW_MODE:
             SetMode(DrawMode);
             break;
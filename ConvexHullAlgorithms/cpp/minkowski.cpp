@@ -0,0 +1,202 @@
+#include "minkowski.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "exact.h"
+
+namespace geom {
+
+namespace {
+
+//lowest y, then lowest x, which is where the edge angles start at 0
+template <class T>
+size_t bottomMost(const PointT<T>* p, size_t n)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (p[i].y < p[best].y || (p[i].y == p[best].y && p[i].x < p[best].x)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/*Half plane of the direction of edge p0->p1: 0 for [0, pi), 1 for [pi, 2*pi),
+* so antiparallel edges never compare equal. Found by comparing coordinates,
+* which is exact whatever their type.
+*/
+template <class T>
+int halfPlane(const PointT<T>& p0, const PointT<T>& p1)
+{
+    return (p1.y > p0.y || (p1.y == p0.y && p1.x > p0.x)) ? 0 : 1;
+}
+
+//> 0 if edge a comes before edge b in counter-clockwise order from angle 0, 0 if they are parallel
+template <class T>
+int compareAngle(const PointT<T>& a0, const PointT<T>& a1, const PointT<T>& b0, const PointT<T>& b1)
+{
+    const int ha = halfPlane(a0, a1), hb = halfPlane(b0, b1);
+    if (ha != hb) {
+        return ha < hb ? 1 : -1;
+    }
+    typedef typename Exact<T>::Area Area;
+    const Area turn = Exact<T>::turn(a0, a1, b0, b1);
+    return Area() < turn ? 1 : turn < Area() ? -1 : 0;
+}
+
+template <class T>
+PointT<T> add(const PointT<T>& a, const PointT<T>& b)
+{
+    return { (T)(a.x + b.x), (T)(a.y + b.y) };
+}
+
+template <class T>
+std::vector<PointT<T>> translate(const PointT<T>* p, size_t n, const PointT<T>& by)
+{
+    std::vector<PointT<T>> out(n);
+    const size_t start = bottomMost(p, n);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = add(p[(start + i) % n], by);
+    }
+    return out;
+}
+
+template <class T>
+std::vector<PointT<T>> minkowskiSumOf(const PointT<T>* a, size_t n, const PointT<T>* b, size_t m)
+{
+    if (n == 0 || m == 0) {
+        return {};
+    }
+    if (n == 1) {
+        return translate(b, m, a[0]);
+    }
+    if (m == 1) {
+        return translate(a, n, b[0]);
+    }
+
+    const size_t sa = bottomMost(a, n);
+    const size_t sb = bottomMost(b, m);
+
+    std::vector<PointT<T>> out;
+    out.reserve(n + m);
+
+    //both edge sequences start at angle 0 and turn left, take whichever turns less next
+    size_t i = 0, j = 0;
+    while (i < n || j < m) {
+        const PointT<T>& pa = a[(sa + i) % n];
+        const PointT<T>& pb = b[(sb + j) % m];
+        out.push_back(add(pa, pb));
+
+        const int turn = compareAngle(pa, a[(sa + i + 1) % n], pb, b[(sb + j + 1) % m]);
+        const bool stepA = i < n && (turn >= 0 || j == m);
+        const bool stepB = j < m && (turn <= 0 || i == n);
+        if (stepA) i++;
+        if (stepB) j++;
+    }
+    return out;
+}
+
+template <class T>
+std::vector<PointT<T>> minkowskiDifferenceOf(const PointT<T>* a, size_t n, const PointT<T>* b, size_t m)
+{
+    std::vector<PointT<T>> reflected(m);
+    for (size_t i = 0; i < m; i++) {
+        reflected[i] = { (T)-b[i].x, (T)-b[i].y };
+    }
+    return minkowskiSumOf(a, n, reflected.data(), m);
+}
+
+const double twoPi = 2 * 3.14159265358979323846;
+
+/*-b: every arc on the reflected disc with its normals turned half a turn.
+* Angles below pi go up by pi and the rest down, so arcs that meet still
+* meet exactly, and the arcs that were past pi come first.
+*/
+std::vector<DiscArc> reflect(const std::vector<DiscArc>& b)
+{
+    const double pi = 0.5 * twoPi;
+    std::vector<DiscArc> front, back;
+    for (const DiscArc& arc : b) {
+        const Point center = { -arc.center.x, -arc.center.y };
+        if (arc.from >= pi) {
+            front.push_back({ center, arc.radius, arc.from - pi, arc.to - pi, arc.disc });
+        }
+        else if (arc.to <= pi) {
+            back.push_back({ center, arc.radius, arc.from + pi, arc.to + pi, arc.disc });
+        }
+        else {
+            back.push_back({ center, arc.radius, arc.from + pi, twoPi, arc.disc });
+            front.push_back({ center, arc.radius, 0, arc.to - pi, arc.disc });
+        }
+    }
+    front.insert(front.end(), back.begin(), back.end());
+    return front;
+}
+
+//both arc lists run from 0 to 2 pi, every stretch where neither changes disc is one arc of the sum
+std::vector<DiscArc> sumOf(const std::vector<DiscArc>& a, const std::vector<DiscArc>& b)
+{
+    std::vector<DiscArc> out;
+    out.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    double from = 0;
+    while (i < a.size() && j < b.size()) {
+        const double to = (std::min)(a[i].to, b[j].to);
+        if (to > from) {
+            out.push_back({ a[i].center + b[j].center, a[i].radius + b[j].radius, from, to, SIZE_MAX });
+        }
+        from = to;
+        if (a[i].to == to) {
+            i++;
+        }
+        if (b[j].to == to) {
+            j++;
+        }
+    }
+    return out;
+}
+
+}
+
+std::vector<Point> minkowskiSum(const Point* a, size_t n, const Point* b, size_t m)
+{
+    return minkowskiSumOf(a, n, b, m);
+}
+
+std::vector<FloatPoint> minkowskiSum(const FloatPoint* a, size_t n, const FloatPoint* b, size_t m)
+{
+    return minkowskiSumOf(a, n, b, m);
+}
+
+std::vector<IntPoint> minkowskiSum(const IntPoint* a, size_t n, const IntPoint* b, size_t m)
+{
+    return minkowskiSumOf(a, n, b, m);
+}
+
+std::vector<Point> minkowskiDifference(const Point* a, size_t n, const Point* b, size_t m)
+{
+    return minkowskiDifferenceOf(a, n, b, m);
+}
+
+std::vector<FloatPoint> minkowskiDifference(const FloatPoint* a, size_t n, const FloatPoint* b, size_t m)
+{
+    return minkowskiDifferenceOf(a, n, b, m);
+}
+
+std::vector<IntPoint> minkowskiDifference(const IntPoint* a, size_t n, const IntPoint* b, size_t m)
+{
+    return minkowskiDifferenceOf(a, n, b, m);
+}
+
+DiscHull minkowskiSum(const DiscHull& a, const DiscHull& b)
+{
+    return DiscHull(sumOf(a.arcs(), b.arcs()));
+}
+
+DiscHull minkowskiDifference(const DiscHull& a, const DiscHull& b)
+{
+    return DiscHull(sumOf(a.arcs(), reflect(b.arcs())));
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef _MINKOWSKI_H
+#define _MINKOWSKI_H
+
+#include <cstddef>
+#include <vector>
+
+#include "dischull.h"
+#include "geometry.h"
+
+namespace geom {
+
+/*Minkowski sum of two convex polygons in O(n + m)
+*
+* Both inputs are walked once from their bottom-most vertex and their edges
+* are merged by angle, so the n*m pairwise sums are never formed.
+*
+* @param a: vertices of the first polygon, counter-clockwise (as quickHull() returns them)
+* @param n: number of vertices in a
+* @param b: vertices of the second polygon, counter-clockwise
+* @param m: number of vertices in b
+*
+* @return vertices of a + b in counter-clockwise order, starting at the bottom-most
+*/
+std::vector<Point> minkowskiSum(const Point* a, size_t n, const Point* b, size_t m);
+
+/*The same sum on float or integer coordinates
+*
+* The IntPoint one compares edge angles exactly in 128 bits. Its vertices are
+* sums of input vertices, so the coordinates need |x|, |y| < 2^30 to fit.
+*/
+std::vector<FloatPoint> minkowskiSum(const FloatPoint* a, size_t n, const FloatPoint* b, size_t m);
+std::vector<IntPoint> minkowskiSum(const IntPoint* a, size_t n, const IntPoint* b, size_t m);
+
+/*Minkowski difference a - b = a + (-b) of two convex polygons in O(n + m)
+*
+* b is reflected through the origin, which keeps it counter-clockwise, and
+* its edges merged with a's as in minkowskiSum(). The result contains the
+* origin exactly when the polygons overlap, and its distance from the
+* origin is theirs, which is what gjk() and epa() search without building it.
+*
+* @return vertices of a - b in counter-clockwise order, starting at the bottom-most
+*/
+std::vector<Point> minkowskiDifference(const Point* a, size_t n, const Point* b, size_t m);
+std::vector<FloatPoint> minkowskiDifference(const FloatPoint* a, size_t n, const FloatPoint* b, size_t m);
+std::vector<IntPoint> minkowskiDifference(const IntPoint* a, size_t n, const IntPoint* b, size_t m);
+
+/*Sum and difference of two rounded shapes in O(h_a + h_b)
+*
+* Support functions add, so where A is on one disc and B on another, the sum
+* is on the disc with the sum of their centers and radii. The two arc lists
+* are merged by normal angle, as polygon edges are. A polygon goes in as
+* DiscHull::rounded() with radius 0, a rounded one with its radius. The arcs
+* of the result have disc SIZE_MAX.
+*/
+DiscHull minkowskiSum(const DiscHull& a, const DiscHull& b);
+DiscHull minkowskiDifference(const DiscHull& a, const DiscHull& b);
+
+}
+
+#endif
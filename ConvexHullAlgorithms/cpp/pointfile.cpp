@@ -0,0 +1,236 @@
+#include "pointfile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace geom {
+
+namespace {
+
+const char pointFileMagic[8] = { 'G', 'E', 'O', 'M', 'P', 'T', 'S', '\0' };
+
+//columns start on cache line boundaries
+const uint64_t columnAlign = 64;
+
+uint64_t alignUp(uint64_t v)
+{
+    return (v + columnAlign - 1) / columnAlign * columnAlign;
+}
+
+//the format is little-endian and columns are read in place, so only little-endian hosts can use it
+bool littleEndian()
+{
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+bool writeZeros(FILE* f, uint64_t count)
+{
+    static const char zeros[columnAlign] = {};
+    while (count > 0) {
+        const size_t chunk = count < columnAlign ? (size_t)count : (size_t)columnAlign;
+        if (std::fwrite(zeros, 1, chunk, f) != chunk) {
+            return false;
+        }
+        count -= chunk;
+    }
+    return true;
+}
+
+//converts one coordinate of pts to T a block at a time and appends it to f
+template <class T>
+bool writeColumn(FILE* f, const Point* pts, size_t n, bool y)
+{
+    std::vector<T> block(4096);
+    for (size_t lo = 0; lo < n; lo += block.size()) {
+        const size_t count = n - lo < block.size() ? n - lo : block.size();
+        for (size_t i = 0; i < count; i++) {
+            block[i] = (T)(y ? pts[lo + i].y : pts[lo + i].x);
+        }
+        if (std::fwrite(block.data(), sizeof(T), count, f) != count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+bool writePointFile(const char* path, const Point* pts, size_t n, Scalar type)
+{
+    if (!littleEndian()) {
+        return false;
+    }
+    const uint64_t columnBytes = (uint64_t)n * (uint32_t)type;
+
+    PointFileHeader header = {};
+    std::memcpy(header.magic, pointFileMagic, sizeof(header.magic));
+    header.version = pointFileVersion;
+    header.scalar = (uint32_t)type;
+    header.count = n;
+    header.xOffset = alignUp(sizeof(PointFileHeader));
+    header.yOffset = alignUp(header.xOffset + columnBytes);
+
+    FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+        writeZeros(f, header.xOffset - sizeof(header));
+    if (type == Scalar::Float32) {
+        ok = ok && writeColumn<float>(f, pts, n, false) &&
+            writeZeros(f, header.yOffset - header.xOffset - columnBytes) &&
+            writeColumn<float>(f, pts, n, true);
+    }
+    else {
+        ok = ok && writeColumn<double>(f, pts, n, false) &&
+            writeZeros(f, header.yOffset - header.xOffset - columnBytes) &&
+            writeColumn<double>(f, pts, n, true);
+    }
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) {
+        std::remove(path);
+    }
+    return ok;
+}
+
+const char* checkPointFileHeader(const PointFileHeader& header, uint64_t length)
+{
+    if (std::memcmp(header.magic, pointFileMagic, sizeof(header.magic)) != 0) {
+        return " is not a point file";
+    }
+    if (header.version != pointFileVersion) {
+        return " has an unsupported version";
+    }
+    if (header.scalar != (uint32_t)Scalar::Float32 && header.scalar != (uint32_t)Scalar::Float64) {
+        return " has an unknown coordinate type";
+    }
+
+    //columns have to be aligned for their type and lie completely inside the file
+    const uint64_t maxCount = length / header.scalar;
+    const uint64_t columnBytes = header.count * header.scalar;
+    if (header.count > maxCount ||
+        header.xOffset < sizeof(PointFileHeader) || header.yOffset < sizeof(PointFileHeader) ||
+        header.xOffset % header.scalar != 0 || header.yOffset % header.scalar != 0 ||
+        header.xOffset > length - columnBytes || header.yOffset > length - columnBytes) {
+        return " is truncated or has a corrupt header";
+    }
+    return nullptr;
+}
+
+bool MappedPoints::fail(const std::string& what)
+{
+    close();
+    message = what;
+    return false;
+}
+
+bool MappedPoints::open(const char* path)
+{
+    close();
+    message.clear();
+    if (!littleEndian()) {
+        return fail("point files can only be mapped on little-endian hosts");
+    }
+
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        return fail(std::string("cannot open ") + path);
+    }
+    file = h;
+    LARGE_INTEGER bytes;
+    if (!GetFileSizeEx(h, &bytes)) {
+        return fail(std::string("cannot read the size of ") + path);
+    }
+    length = (size_t)bytes.QuadPart;
+    if (length < sizeof(PointFileHeader)) {
+        return fail(std::string(path) + " is too short to be a point file");
+    }
+    mapping = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        return fail(std::string("cannot map ") + path);
+    }
+    base = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        return fail(std::string("cannot map ") + path);
+    }
+#else
+    fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return fail(std::string("cannot open ") + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return fail(std::string("cannot read the size of ") + path);
+    }
+    length = (size_t)st.st_size;
+    if (length < sizeof(PointFileHeader)) {
+        return fail(std::string(path) + " is too short to be a point file");
+    }
+    void* view = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        return fail(std::string("cannot map ") + path);
+    }
+    base = (const unsigned char*)view;
+#endif
+
+    PointFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (const char* problem = checkPointFileHeader(header, length)) {
+        return fail(std::string(path) + problem);
+    }
+
+    count = (size_t)header.count;
+    type = (Scalar)header.scalar;
+    xOffset = header.xOffset;
+    yOffset = header.yOffset;
+    return true;
+}
+
+void MappedPoints::close()
+{
+#ifdef _WIN32
+    if (base) {
+        UnmapViewOfFile(base);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file) {
+        CloseHandle(file);
+    }
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (base) {
+        munmap((void*)base, length);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+#endif
+    base = nullptr;
+    length = 0;
+    count = 0;
+    xOffset = 0;
+    yOffset = 0;
+}
+
+}
@@ -0,0 +1,107 @@
+#ifndef _POINTFILE_H
+#define _POINTFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "geometry.h"
+
+namespace geom {
+
+/*Binary point file layout
+*
+* A 64 byte header, then the x column and the y column. Each column is a
+* packed little-endian array of float32 or float64 starting at a 64 byte
+* aligned offset, so a mapped file can be read in place as two arrays.
+*/
+enum class Scalar : uint32_t
+{
+    Float32 = 4,
+    Float64 = 8,
+};
+
+struct PointFileHeader
+{
+    char     magic[8];      //"GEOMPTS" and a nul
+    uint32_t version;       //pointFileVersion
+    uint32_t scalar;        //Scalar, bytes per coordinate
+    uint64_t count;
+    uint64_t xOffset;       //byte offsets of the columns from the start of the file
+    uint64_t yOffset;
+    uint8_t  reserved[24];
+};
+
+static_assert(sizeof(PointFileHeader) == 64, "the header is part of the file format");
+
+const uint32_t pointFileVersion = 1;
+
+/*Checks a header read from a file of length bytes
+*
+* @return null if the columns it describes are valid and inside the file,
+*         otherwise what is wrong, phrased to follow the file name
+*/
+const char* checkPointFileHeader(const PointFileHeader& header, uint64_t length);
+
+/*Writes points to a new point file, replacing path
+*
+* @param type: precision of the stored columns, Float32 rounds the coordinates
+*
+* @return false if the file could not be written
+*/
+bool writePointFile(const char* path, const Point* pts, size_t n, Scalar type);
+
+/*Read-only memory mapping of a point file
+*
+* The columns point straight into the mapping: opening costs the same for
+* any file size, pages are read in on first touch and processes that map
+* the same file share them. Run the engines on the columns through the
+* x/y overloads, e.g. quickHull(file.xFloat64(), file.yFloat64(), file.size()).
+*/
+class MappedPoints
+{
+public:
+    MappedPoints() = default;
+    ~MappedPoints() { close(); }
+    MappedPoints(const MappedPoints&) = delete;
+    MappedPoints& operator=(const MappedPoints&) = delete;
+
+    //maps path, false with error() set if it can't be mapped or is not a valid point file
+    bool open(const char* path);
+    void close();
+
+    bool   isOpen() const { return base != nullptr; }
+    size_t size() const { return count; }
+    Scalar scalar() const { return type; }
+
+    //columns, null unless they are stored with that precision
+    const float*  xFloat32() const { return type == Scalar::Float32 ? (const float*)column(xOffset) : nullptr; }
+    const float*  yFloat32() const { return type == Scalar::Float32 ? (const float*)column(yOffset) : nullptr; }
+    const double* xFloat64() const { return type == Scalar::Float64 ? (const double*)column(xOffset) : nullptr; }
+    const double* yFloat64() const { return type == Scalar::Float64 ? (const double*)column(yOffset) : nullptr; }
+
+    const std::string& error() const { return message; }
+
+private:
+    const void* column(uint64_t offset) const { return base ? base + offset : nullptr; }
+    bool fail(const std::string& what);
+
+    const unsigned char* base = nullptr;
+    size_t      length = 0;
+    size_t      count = 0;
+    Scalar      type = Scalar::Float64;
+    uint64_t    xOffset = 0;
+    uint64_t    yOffset = 0;
+    std::string message;
+
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+}
+
+#endif
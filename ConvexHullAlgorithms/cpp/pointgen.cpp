@@ -0,0 +1,99 @@
+#include "pointgen.h"
+
+#include <cmath>
+
+namespace geom {
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+class SplitMix64
+{
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    //uniform in [0, 1), 53 random bits
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    //standard normal, Box-Muller without caching the second value
+    double normal()
+    {
+        const double u = 1.0 - uniform();
+        const double v = uniform();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * pi * v);
+    }
+
+private:
+    uint64_t state;
+};
+
+}
+
+const char* distributionName(Distribution d)
+{
+    switch (d) {
+    case Distribution::UniformSquare: return "square";
+    case Distribution::UniformDisk:   return "disk";
+    case Distribution::OnCircle:      return "circle";
+    case Distribution::Gaussian:      return "gaussian";
+    case Distribution::Clustered:     return "clustered";
+    }
+    return "?";
+}
+
+std::vector<Point> generatePoints(Distribution d, size_t n, uint64_t seed)
+{
+    SplitMix64 rng(seed);
+    std::vector<Point> pts(n);
+
+    switch (d) {
+    case Distribution::UniformSquare:
+        for (Point& p : pts) {
+            p.x = 2.0 * rng.uniform() - 1.0;
+            p.y = 2.0 * rng.uniform() - 1.0;
+        }
+        break;
+    case Distribution::UniformDisk:
+        for (Point& p : pts) {
+            const double r = std::sqrt(rng.uniform());
+            const double t = 2.0 * pi * rng.uniform();
+            p = { r * std::cos(t), r * std::sin(t) };
+        }
+        break;
+    case Distribution::OnCircle:
+        for (Point& p : pts) {
+            const double t = 2.0 * pi * rng.uniform();
+            p = { std::cos(t), std::sin(t) };
+        }
+        break;
+    case Distribution::Gaussian:
+        for (Point& p : pts) {
+            p = { rng.normal(), rng.normal() };
+        }
+        break;
+    case Distribution::Clustered: {
+        const size_t clusters = 16;
+        Point centers[clusters];
+        for (Point& c : centers) {
+            c = { 2.0 * rng.uniform() - 1.0, 2.0 * rng.uniform() - 1.0 };
+        }
+        for (Point& p : pts) {
+            const Point& c = centers[rng.next() % clusters];
+            p = { c.x + 0.02 * rng.normal(), c.y + 0.02 * rng.normal() };
+        }
+        break;
+    }
+    }
+    return pts;
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef _POINTGEN_H
+#define _POINTGEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+enum class Distribution
+{
+    UniformSquare,  //uniform in [-1, 1]^2, h ~ log n
+    UniformDisk,    //uniform in the unit disk, h ~ n^(1/3)
+    OnCircle,       //on the unit circle, every point is a hull vertex (h = n)
+    Gaussian,       //standard normal in x and y
+    Clustered,      //a few tight gaussian blobs at uniform centers
+};
+
+const Distribution allDistributions[] = {
+    Distribution::UniformSquare,
+    Distribution::UniformDisk,
+    Distribution::OnCircle,
+    Distribution::Gaussian,
+    Distribution::Clustered,
+};
+
+const char* distributionName(Distribution d);
+
+/*Generates a reproducible point cloud
+*
+* Uses its own splitmix64 stream rather than <random> distributions, whose
+* output differs between standard libraries, so a seed gives the same points
+* on every platform.
+*
+* @param d: distribution to draw from
+* @param n: number of points
+* @param seed: same seed, same points
+*/
+std::vector<Point> generatePoints(Distribution d, size_t n, uint64_t seed);
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "pointstore.h"
+
+namespace geom {
+
+PointHandle PointStore::insert(float x, float y, float radiusX, float radiusY, const Color& color)
+{
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back({ 0, 0 });
+    }
+    slots[slot].index = static_cast<uint32_t>(xs.size());
+
+    xs.push_back(x);
+    ys.push_back(y);
+    rxs.push_back(radiusX);
+    rys.push_back(radiusY);
+    colors.push_back(color);
+    denseToSlot.push_back(slot);
+    changes++;
+
+    return { slot, slots[slot].generation };
+}
+
+bool PointStore::erase(PointHandle h)
+{
+    if (!contains(h)) {
+        return false;
+    }
+    const uint32_t i = slots[h.slot].index;
+    const uint32_t last = static_cast<uint32_t>(xs.size() - 1);
+
+    //fill the hole with the last point so the columns stay packed
+    xs[i] = xs[last];
+    ys[i] = ys[last];
+    rxs[i] = rxs[last];
+    rys[i] = rys[last];
+    colors[i] = colors[last];
+    denseToSlot[i] = denseToSlot[last];
+    slots[denseToSlot[i]].index = i;
+
+    xs.pop_back();
+    ys.pop_back();
+    rxs.pop_back();
+    rys.pop_back();
+    colors.pop_back();
+    denseToSlot.pop_back();
+
+    slots[h.slot].generation++;
+    freeSlots.push_back(h.slot);
+    changes++;
+    return true;
+}
+
+void PointStore::clear()
+{
+    for (uint32_t slot : denseToSlot) {
+        slots[slot].generation++;
+        freeSlots.push_back(slot);
+    }
+    xs.clear();
+    ys.clear();
+    rxs.clear();
+    rys.clear();
+    colors.clear();
+    denseToSlot.clear();
+    changes++;
+}
+
+void PointStore::reserve(size_t n)
+{
+    xs.reserve(n);
+    ys.reserve(n);
+    rxs.reserve(n);
+    rys.reserve(n);
+    colors.reserve(n);
+    denseToSlot.reserve(n);
+}
+
+}
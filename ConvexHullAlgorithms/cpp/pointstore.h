@@ -0,0 +1,106 @@
+#ifndef _POINTSTORE_H
+#define _POINTSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace geom {
+
+struct Color
+{
+    float r, g, b, a;
+};
+
+/*Stable reference to a point in a PointStore
+*
+* Stays valid across inserts and across erasing other points. Once its own
+* point is erased (or the store cleared) the generation no longer matches
+* and PointStore::contains() returns false, even if the slot is reused.
+*/
+struct PointHandle
+{
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+inline bool operator==(const PointHandle& a, const PointHandle& b) { return a.slot == b.slot && a.generation == b.generation; }
+inline bool operator!=(const PointHandle& a, const PointHandle& b) { return !(a == b); }
+
+/*Structure-of-arrays storage for drawable points
+*
+* Every attribute lives in its own contiguous column, indexed 0..size()-1,
+* so drawing, hit testing and hull building are plain linear scans with no
+* per point allocation or reference counting. Handles go through a slot
+* table; erasing moves the last point into the hole, so dense indices are
+* only stable until the next erase but handles always are. The same goes
+* for the order a scan visits the points in, it is insertion order only
+* until the first erase.
+*/
+class PointStore
+{
+public:
+    PointHandle insert(float x, float y, float radiusX, float radiusY, const Color& color);
+
+    //returns false if the handle was already stale
+    bool erase(PointHandle h);
+
+    void clear();
+    void reserve(size_t n);
+
+    bool contains(PointHandle h) const
+    {
+        return h.slot < slots.size() && slots[h.slot].generation == h.generation;
+    }
+
+    //dense index of a handle, h must be contained
+    size_t indexOf(PointHandle h) const { return slots[h.slot].index; }
+
+    PointHandle handleAt(size_t i) const { return { denseToSlot[i], slots[denseToSlot[i]].generation }; }
+
+    //handle of the point in a slot, for indexes kept by slot; the slot must hold a point
+    PointHandle handleAtSlot(uint32_t slot) const { return { slot, slots[slot].generation }; }
+
+    size_t size() const { return xs.size(); }
+    bool   empty() const { return xs.empty(); }
+
+    float        x(size_t i) const { return xs[i]; }
+    float        y(size_t i) const { return ys[i]; }
+    float        radiusX(size_t i) const { return rxs[i]; }
+    float        radiusY(size_t i) const { return rys[i]; }
+    const Color& color(size_t i) const { return colors[i]; }
+
+    void move(size_t i, float x, float y)
+    {
+        xs[i] = x;
+        ys[i] = y;
+        changes++;
+    }
+
+    //bumped by every insert, erase, move and clear, so callers can tell if anything changed
+    uint64_t version() const { return changes; }
+
+    //whole columns, for passes that run over every point
+    const float* xData() const { return xs.data(); }
+    const float* yData() const { return ys.data(); }
+
+private:
+    struct Slot
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    std::vector<float>    xs, ys, rxs, rys;
+    std::vector<Color>    colors;
+    std::vector<uint32_t> denseToSlot;
+
+    std::vector<Slot>     slots;
+    std::vector<uint32_t> freeSlots;
+
+    uint64_t              changes = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,377 @@
+#include "predicates.h"
+
+#include <cmath>
+
+//the error-free transformations below stop being exact if a * b + c is fused
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace geom {
+
+namespace detail {
+
+/*Expansion arithmetic after J. R. Shewchuk, "Adaptive Precision Floating-Point
+* Arithmetic and Fast Robust Geometric Predicates" (1997).
+*
+* An expansion is an array of doubles, smallest magnitude first, that do not
+* overlap, so their exact sum is the value and the last one carries its sign.
+*/
+namespace {
+
+const double splitter = 134217729.0;   //2^27 + 1
+const double resultBound = (3.0 + 8.0 * epsilon) * epsilon;
+const double orientBoundB = (2.0 + 12.0 * epsilon) * epsilon;
+const double orientBoundC = (9.0 + 64.0 * epsilon) * epsilon * epsilon;
+const double incircleBound = (10.0 + 96.0 * epsilon) * epsilon;
+const double crossBound = (8.0 + 64.0 * epsilon) * epsilon;
+const double intersectionBound = (16.0 + 128.0 * epsilon) * epsilon;
+
+//x + y == a + b exactly, |a| >= |b|
+inline void fastTwoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    y = b - (x - a);
+}
+
+inline void twoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    const double bv = x - a;
+    const double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+
+//the rounding error of x = a - b
+inline double twoDiffTail(double a, double b, double x)
+{
+    const double bv = a - x;
+    const double av = x + bv;
+    return (a - av) + (bv - b);
+}
+
+inline void twoDiff(double a, double b, double& x, double& y)
+{
+    x = a - b;
+    y = twoDiffTail(a, b, x);
+}
+
+//a == hi + lo with both halves of 26 bits
+inline void split(double a, double& hi, double& lo)
+{
+    const double c = splitter * a;
+    hi = c - (c - a);
+    lo = a - hi;
+}
+
+inline void twoProduct(double a, double b, double& x, double& y)
+{
+    x = a * b;
+    double ahi, alo, bhi, blo;
+    split(a, ahi, alo);
+    split(b, bhi, blo);
+    const double err = x - ahi * bhi - alo * bhi - ahi * blo;
+    y = alo * blo - err;
+}
+
+//a1 + a0 - (b1 + b0) as four components
+inline void twoTwoDiff(double a1, double a0, double b1, double b0, double* x)
+{
+    double i, j, k;
+    twoDiff(a0, b0, i, x[0]);
+    twoSum(a1, i, j, k);
+    double m;
+    twoDiff(k, b1, m, x[1]);
+    twoSum(j, m, x[3], x[2]);
+}
+
+/*h = e + f, zero components dropped
+*
+* @return length of h, at most elen + flen
+*/
+int sumExpansions(int elen, const double* e, int flen, const double* f, double* h)
+{
+    int ei = 0, fi = 0, hi = 0;
+    double q, qnew, hh;
+    //next component by magnitude
+    auto take = [&]() {
+        if (fi == flen || (ei < elen && (f[fi] > e[ei]) == (f[fi] > -e[ei]))) {
+            return e[ei++];
+        }
+        return f[fi++];
+    };
+    q = take();
+    if (ei + fi < elen + flen) {
+        fastTwoSum(take(), q, qnew, hh);
+        q = qnew;
+        if (hh != 0.0) h[hi++] = hh;
+    }
+    while (ei + fi < elen + flen) {
+        twoSum(q, take(), qnew, hh);
+        q = qnew;
+        if (hh != 0.0) h[hi++] = hh;
+    }
+    if (q != 0.0 || hi == 0) {
+        h[hi++] = q;
+    }
+    return hi;
+}
+
+//h = b * e, zero components dropped, at most 2 * elen long
+int scaleExpansion(int elen, const double* e, double b, double* h)
+{
+    int hi = 0;
+    double q, hh;
+    twoProduct(e[0], b, q, hh);
+    if (hh != 0.0) h[hi++] = hh;
+    for (int i = 1; i < elen; i++) {
+        double p1, p0, sum;
+        twoProduct(e[i], b, p1, p0);
+        twoSum(q, p0, sum, hh);
+        if (hh != 0.0) h[hi++] = hh;
+        fastTwoSum(p1, sum, q, hh);
+        if (hh != 0.0) h[hi++] = hh;
+    }
+    if (q != 0.0 || hi == 0) {
+        h[hi++] = q;
+    }
+    return hi;
+}
+
+//h = e * f, at most 2 * elen * flen long, scratch as long as h
+int multiplyExpansions(int elen, const double* e, int flen, const double* f, double* h, double* scratch)
+{
+    double part[2 * 16];
+    int hlen = scaleExpansion(elen, e, f[0], h);
+    for (int i = 1; i < flen; i++) {
+        const int plen = scaleExpansion(elen, e, f[i], part);
+        for (int k = 0; k < hlen; k++) {
+            scratch[k] = h[k];
+        }
+        hlen = sumExpansions(hlen, scratch, plen, part, h);
+    }
+    return hlen;
+}
+
+void negate(int len, double* e)
+{
+    for (int i = 0; i < len; i++) {
+        e[i] = -e[i];
+    }
+}
+
+//a - b exactly, one or two components
+int difference(double a, double b, double* h)
+{
+    double x, y;
+    twoDiff(a, b, x, y);
+    if (y == 0.0) {
+        h[0] = x;
+        return 1;
+    }
+    h[0] = y;
+    h[1] = x;
+    return 2;
+}
+
+//p * s - q * t exactly, each factor an expansion of at most 2 components
+int crossExpansion(int plen, const double* p, int slen, const double* s,
+    int qlen, const double* q, int tlen, const double* t, double* h)
+{
+    double ps[8], qt[8], scratch[8];
+    const int pslen = multiplyExpansions(plen, p, slen, s, ps, scratch);
+    const int qtlen = multiplyExpansions(qlen, q, tlen, t, qt, scratch);
+    negate(qtlen, qt);
+    return sumExpansions(pslen, ps, qtlen, qt, h);
+}
+
+//adx^2 + ady^2 exactly
+int liftExpansion(int xlen, const double* x, int ylen, const double* y, double* h)
+{
+    double xx[8], yy[8], scratch[8];
+    const int xxlen = multiplyExpansions(xlen, x, xlen, x, xx, scratch);
+    const int yylen = multiplyExpansions(ylen, y, ylen, y, yy, scratch);
+    return sumExpansions(xxlen, xx, yylen, yy, h);
+}
+
+//the in-circle determinant without any rounding, only reached near zero
+double incircleExact(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+    double adx[2], ady[2], bdx[2], bdy[2], cdx[2], cdy[2];
+    const int adxl = difference(a.x, d.x, adx), adyl = difference(a.y, d.y, ady);
+    const int bdxl = difference(b.x, d.x, bdx), bdyl = difference(b.y, d.y, bdy);
+    const int cdxl = difference(c.x, d.x, cdx), cdyl = difference(c.y, d.y, cdy);
+
+    //lift(a) * cross(b, c) + lift(b) * cross(c, a) + lift(c) * cross(a, b)
+    double lift[16], cross[16], term[3][512], scratch[512];
+    int termlen[3];
+    int liftlen = liftExpansion(adxl, adx, adyl, ady, lift);
+    int crosslen = crossExpansion(bdxl, bdx, cdyl, cdy, bdyl, bdy, cdxl, cdx, cross);
+    termlen[0] = multiplyExpansions(liftlen, lift, crosslen, cross, term[0], scratch);
+    liftlen = liftExpansion(bdxl, bdx, bdyl, bdy, lift);
+    crosslen = crossExpansion(cdxl, cdx, adyl, ady, cdyl, cdy, adxl, adx, cross);
+    termlen[1] = multiplyExpansions(liftlen, lift, crosslen, cross, term[1], scratch);
+    liftlen = liftExpansion(cdxl, cdx, cdyl, cdy, lift);
+    crosslen = crossExpansion(adxl, adx, bdyl, bdy, adyl, ady, bdxl, bdx, cross);
+    termlen[2] = multiplyExpansions(liftlen, lift, crosslen, cross, term[2], scratch);
+
+    double ab[1024], det[1536];
+    const int ablen = sumExpansions(termlen[0], term[0], termlen[1], term[1], ab);
+    const int detlen = sumExpansions(ablen, ab, termlen[2], term[2], det);
+    return det[detlen - 1];
+}
+
+/*compareIntersection() without any rounding
+*
+* With u = b - a, v = d - c and w = c - a the intersection is a + t * u for
+* t = cross(w, v) / cross(u, v), so its offset from s times cross(u, v) is
+* (a - s) * cross(u, v) + cross(w, v) * u, one polynomial per coordinate.
+*/
+int compareIntersectionExact(const Point& a, const Point& b, const Point& c, const Point& d, const Point& s)
+{
+    double ux[2], uy[2], vx[2], vy[2], wx[2], wy[2];
+    const int uxl = difference(b.x, a.x, ux), uyl = difference(b.y, a.y, uy);
+    const int vxl = difference(d.x, c.x, vx), vyl = difference(d.y, c.y, vy);
+    const int wxl = difference(c.x, a.x, wx), wyl = difference(c.y, a.y, wy);
+
+    double uv[16], wv[16];
+    const int uvl = crossExpansion(uxl, ux, vyl, vy, uyl, uy, vxl, vx, uv);
+    const int wvl = crossExpansion(wxl, wx, vyl, vy, wyl, wy, vxl, vx, wv);
+    const int sign = uv[uvl - 1] > 0 ? 1 : uv[uvl - 1] < 0 ? -1 : 0;
+    if (sign == 0) {
+        return 0;
+    }
+
+    //x decides unless it is exactly equal, then y
+    double ds[2], first[64], second[64], sum[128], scratch[64];
+    for (int axis = 0; axis < 2; axis++) {
+        const int dsl = axis == 0 ? difference(a.x, s.x, ds) : difference(a.y, s.y, ds);
+        const int firstl = multiplyExpansions(uvl, uv, dsl, ds, first, scratch);
+        const int secondl = axis == 0 ? multiplyExpansions(wvl, wv, uxl, ux, second, scratch)
+                                      : multiplyExpansions(wvl, wv, uyl, uy, second, scratch);
+        const int suml = sumExpansions(firstl, first, secondl, second, sum);
+        const double e = sum[suml - 1];
+        if (e != 0.0) {
+            return e > 0 ? sign : -sign;
+        }
+    }
+    return 0;
+}
+
+}
+
+/*Orientation in up to three more precise stages, each stopping as soon as
+* its error bound settles the sign. The last one is exact.
+*/
+double orient2dAdapt(const Point& a, const Point& b, const Point& c, double detsum)
+{
+    const double acx = a.x - c.x;
+    const double bcx = b.x - c.x;
+    const double acy = a.y - c.y;
+    const double bcy = b.y - c.y;
+
+    //products exact, differences rounded
+    double l1, l0, r1, r0, B[4];
+    twoProduct(acx, bcy, l1, l0);
+    twoProduct(acy, bcx, r1, r0);
+    twoTwoDiff(l1, l0, r1, r0, B);
+    double det = B[0] + B[1] + B[2] + B[3];
+    double bound = orientBoundB * detsum;
+    if (det >= bound || -det >= bound) {
+        return det;
+    }
+
+    const double acxtail = twoDiffTail(a.x, c.x, acx);
+    const double bcxtail = twoDiffTail(b.x, c.x, bcx);
+    const double acytail = twoDiffTail(a.y, c.y, acy);
+    const double bcytail = twoDiffTail(b.y, c.y, bcy);
+    if (acxtail == 0.0 && acytail == 0.0 && bcxtail == 0.0 && bcytail == 0.0) {
+        return det;
+    }
+
+    //first order correction for the rounded differences
+    bound = orientBoundC * detsum + resultBound * std::fabs(det);
+    det += (acx * bcytail + bcy * acxtail) - (acy * bcxtail + bcx * acytail);
+    if (det >= bound || -det >= bound) {
+        return det;
+    }
+
+    //exact: the tails' products summed into B
+    double s1, s0, t1, t0, u[4], C1[8], C2[12], D[16];
+    twoProduct(acxtail, bcy, s1, s0);
+    twoProduct(acytail, bcx, t1, t0);
+    twoTwoDiff(s1, s0, t1, t0, u);
+    const int c1len = sumExpansions(4, B, 4, u, C1);
+    twoProduct(acx, bcytail, s1, s0);
+    twoProduct(acy, bcxtail, t1, t0);
+    twoTwoDiff(s1, s0, t1, t0, u);
+    const int c2len = sumExpansions(c1len, C1, 4, u, C2);
+    twoProduct(acxtail, bcytail, s1, s0);
+    twoProduct(acytail, bcxtail, t1, t0);
+    twoTwoDiff(s1, s0, t1, t0, u);
+    const int dlen = sumExpansions(c2len, C2, 4, u, D);
+    return D[dlen - 1];
+}
+
+}
+
+double incircle(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+    const double adx = a.x - d.x, ady = a.y - d.y;
+    const double bdx = b.x - d.x, bdy = b.y - d.y;
+    const double cdx = c.x - d.x, cdy = c.y - d.y;
+
+    const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    const double cdxady = cdx * ady, adxcdy = adx * cdy;
+    const double adxbdy = adx * bdy, bdxady = bdx * ady;
+    const double alift = adx * adx + ady * ady;
+    const double blift = bdx * bdx + bdy * bdy;
+    const double clift = cdx * cdx + cdy * cdy;
+
+    const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    const double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift +
+        (std::fabs(cdxady) + std::fabs(adxcdy)) * blift +
+        (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+    const double bound = detail::incircleBound * permanent;
+    if (det > bound || -det > bound) {
+        return det;
+    }
+    return detail::incircleExact(a, b, c, d);
+}
+
+int compareIntersection(const Point& a, const Point& b, const Point& c, const Point& d, const Point& s)
+{
+    const double ux = b.x - a.x, uy = b.y - a.y;
+    const double vx = d.x - c.x, vy = d.y - c.y;
+    const double wx = c.x - a.x, wy = c.y - a.y;
+
+    //the sign of cross(u, v) first, the intersection is scaled by it
+    const double uvl = ux * vy, uvr = uy * vx;
+    const double uv = uvl - uvr;
+    const double uvsum = std::fabs(uvl) + std::fabs(uvr);
+    if (!(uv > detail::crossBound * uvsum || -uv > detail::crossBound * uvsum)) {
+        return detail::compareIntersectionExact(a, b, c, d, s);
+    }
+    const int sign = uv > 0 ? 1 : -1;
+
+    const double wvl = wx * vy, wvr = wy * vx;
+    const double wv = wvl - wvr;
+    const double wvsum = std::fabs(wvl) + std::fabs(wvr);
+    const double offsets[2][2] = { { a.x - s.x, ux }, { a.y - s.y, uy } };
+    for (const auto& o : offsets) {
+        const double e = o[0] * uv + wv * o[1];
+        const double permanent = std::fabs(o[0]) * uvsum + wvsum * std::fabs(o[1]);
+        const double bound = detail::intersectionBound * permanent;
+        if (e > bound || -e > bound) {
+            return e > 0 ? sign : -sign;
+        }
+        if (permanent != 0.0) {
+            return detail::compareIntersectionExact(a, b, c, d, s);
+        }
+    }
+    return 0;
+}
+
+}
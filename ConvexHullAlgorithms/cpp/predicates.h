@@ -0,0 +1,75 @@
+#ifndef _PREDICATES_H
+#define _PREDICATES_H
+
+#include "geometry.h"
+
+namespace geom {
+
+/*Orientation, in-circle and line intersection tests whose sign is always right
+*
+* orient() and the other plain expressions can get the sign wrong when the
+* points are close to collinear, which is common on gridded input, and a
+* hull routine that branches on a wrong sign can emit a bad hull or fail to
+* terminate. These run the same float expression first and only fall back
+* to Shewchuk's adaptive exact arithmetic when the result is within the
+* rounding error bound of zero, so ordinary inputs pay a couple of extra
+* compares.
+*/
+
+namespace detail {
+
+//half an ulp of 1, 2^-53
+const double epsilon = 1.1102230246251565e-16;
+
+//bound on the rounding error of the float orientation, relative to |l| + |r|
+const double orientBound = (3.0 + 16.0 * epsilon) * epsilon;
+
+double orient2dAdapt(const Point& a, const Point& b, const Point& c, double detsum);
+
+}
+
+/*orient(a, b, c) with an exact sign: > 0 when c is left of a->b, < 0 right
+* of it and 0 only when the three points are exactly collinear. The value is
+* an approximation of twice the signed area.
+*/
+inline double orient2d(const Point& a, const Point& b, const Point& c)
+{
+    const double l = (a.x - c.x) * (b.y - c.y);
+    const double r = (a.y - c.y) * (b.x - c.x);
+    const double det = l - r;
+
+    //opposite signs cannot cancel
+    double detsum;
+    if (l > 0) {
+        if (r <= 0) return det;
+        detsum = l + r;
+    }
+    else if (l < 0) {
+        if (r >= 0) return det;
+        detsum = -l - r;
+    }
+    else {
+        return det;
+    }
+    const double bound = detail::orientBound * detsum;
+    if (det >= bound || -det >= bound) {
+        return det;
+    }
+    return detail::orient2dAdapt(a, b, c, detsum);
+}
+
+/*> 0 when d lies inside the circle through a, b and c (counter-clockwise),
+* < 0 outside it and 0 exactly on it
+*/
+double incircle(const Point& a, const Point& b, const Point& c, const Point& d);
+
+/*Where the intersection of line ab and line cd lies relative to s, in
+* lexicographic (x, then y) order: > 0 after s, < 0 before it and 0 when it
+* is exactly s or the lines are parallel. A degree 3 test, so the exact
+* fallback is taken more often than orient2d's.
+*/
+int compareIntersection(const Point& a, const Point& b, const Point& c, const Point& d, const Point& s);
+
+}
+
+#endif
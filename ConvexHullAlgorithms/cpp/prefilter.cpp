@@ -0,0 +1,67 @@
+#include "prefilter.h"
+
+#include <algorithm>
+
+#include "simd.h"
+
+namespace geom {
+
+namespace {
+
+//directions the extremes are taken in, counter-clockwise from straight down,
+//so the extreme points come out in hull order
+const Point octagon[8] = { { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 } };
+const Point quadrilateral[4] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+//below this the passes cost more than the hull algorithms save
+const size_t minPoints = 64;
+
+//points tested per call, the marks stay on the stack
+const size_t block = 4096;
+
+}
+
+std::vector<size_t> aklToussaint(const Point* pts, size_t n, size_t directions)
+{
+    std::vector<size_t> keep;
+    const Point* dirs = directions == 4 ? quadrilateral : octagon;
+    const size_t count = directions == 4 ? 4 : 8;
+
+    //neighbouring directions can share an extreme point
+    Point poly[8];
+    size_t k = 0;
+    if (n >= minPoints) {
+        size_t extreme[8];
+        simd::argmaxDots(&pts[0].x, 2, n, dirs, count, extreme);
+        for (size_t d = 0; d < count; d++) {
+            const Point p = pts[extreme[d]];
+            if (k == 0 || p != poly[k - 1]) {
+                poly[k++] = p;
+            }
+        }
+        if (k > 1 && poly[k - 1] == poly[0]) {
+            k--;
+        }
+    }
+    if (k < 3) {
+        keep.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            keep[i] = i;
+        }
+        return keep;
+    }
+
+    uint8_t marks[block];
+    for (size_t lo = 0; lo < n; lo += block) {
+        const size_t hi = std::min(n, lo + block);
+        simd::outsideConvex(&pts[lo].x, 2, hi - lo, poly, k, marks);
+        for (size_t i = lo; i < hi; i++) {
+            if (marks[i - lo]) {
+                keep.push_back(i);
+            }
+        }
+    }
+    return keep;
+}
+
+}
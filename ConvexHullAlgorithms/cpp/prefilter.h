@@ -0,0 +1,56 @@
+#ifndef _PREFILTER_H
+#define _PREFILTER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+/*Akl-Toussaint interior point filter
+*
+* Takes the extreme points in 4 (axis) or 8 (axis and diagonal) directions.
+* They are hull vertices or lie on hull edges, so every point strictly
+* inside the polygon they form is inside the hull and can be dropped before
+* a hull algorithm sees it. On uniform inputs that is well over 90% of the
+* points, for the price of two streaming passes.
+*
+* @param directions: 4 or 8
+*
+* @return indices of the points that can still be hull vertices, ascending,
+*         so duplicates keep their order and a hull of the survivors starts
+*         at the same index as a hull of all points
+*/
+std::vector<size_t> aklToussaint(const Point* pts, size_t n, size_t directions = 8);
+
+/*Runs hull over the points aklToussaint() keeps and maps the result back
+*
+* @param hull: the engine, anything called as hull(const Point*, size_t). It
+*              is a template parameter so a policy's hull, see Filtered in
+*              dispatch.h, is called directly rather than through a pointer.
+*
+* @return indices into pts, the same hull hull(pts, n) gives, though where
+*         points repeat a later vertex may be a different copy
+*/
+template <class Hull>
+std::vector<size_t> filteredHull(const Point* pts, size_t n, Hull hull, size_t directions = 8)
+{
+    const std::vector<size_t> keep = aklToussaint(pts, n, directions);
+    if (keep.size() == n) {
+        return hull(pts, n);
+    }
+    std::vector<Point> survivors(keep.size());
+    for (size_t k = 0; k < keep.size(); k++) {
+        survivors[k] = pts[keep[k]];
+    }
+    std::vector<size_t> out = hull(survivors.data(), survivors.size());
+    for (size_t& i : out) {
+        i = keep[i];
+    }
+    return out;
+}
+
+}
+
+#endif
@@ -4,12 +4,19 @@
 #define ID_DRAW_MODE                  40003
 #define ID_SELECT_MODE                40004
 
-//Current Algorithm
+//Algorithm buttons, see algorithmButtons in main.cpp
 #define MDIFFERENCE 50
 #define MSUM 100
 #define QHULL 150
 #define PCHULL 200
 #define GJK 250
+#define WINDOW 300
+#define IMPACT 350
+#define DISCS 400
+#define DYNAMIC 450
 #define MAX_LOADSTRING 100
 
+//Timer streaming points into the WINDOW graph
+#define STREAM_TIMER 1
+
 //</SnippetResource_H>
@@ -0,0 +1,977 @@
+#include "simd.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "predicates.h"
+
+//AVX-512 implies FMA, and fusing a * b - c * d would round differently
+//from the scalar loop
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GEOM_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+//MSVC lets any function use the intrinsics, the dispatcher keeps them off CPUs without them
+#define GEOM_AVX2
+#define GEOM_AVX512
+#else
+//only these functions are compiled for the wider units, so the rest of the
+//program still runs on any x86
+#define GEOM_AVX2 __attribute__((target("avx2")))
+#define GEOM_AVX512 __attribute__((target("avx512f")))
+#endif
+#else
+#define GEOM_SIMD_X86 0
+#endif
+
+namespace geom {
+namespace simd {
+
+namespace {
+
+/*Point layouts, at(i) reads one point for the scalar loops and the tails of
+* the vector loops
+*/
+struct Strided
+{
+    const double* xy;
+    size_t stride;
+
+    Point at(size_t i) const { return { xy[i * stride], xy[i * stride + 1] }; }
+};
+
+template <class T>
+struct Split
+{
+    const T* x;
+    const T* y;
+
+    Point at(size_t i) const { return { (double)x[i], (double)y[i] }; }
+};
+
+//the rules every version follows, written once
+
+inline bool farther(double d, double along, const Farthest& best)
+{
+    return d > best.dist || (d == best.dist && along > best.along);
+}
+
+//-orient(a, b, p), as the vector loops compute it
+inline double rightOf(const Point& a, const Point& dir, const Point& p)
+{
+    return dir.y * (p.x - a.x) - dir.x * (p.y - a.y);
+}
+
+//exact test, for the points the vector loops cannot decide
+bool strictlyInside(const Point& p, const Point* poly, size_t k)
+{
+    for (size_t j = 0; j < k; j++) {
+        if (orient2d(poly[j], poly[j + 1 == k ? 0 : j + 1], p) <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class View>
+void farthestTail(const View& v, size_t from, size_t n, const Point& a, const Point& b, Farthest& best)
+{
+    const Point dir = b - a;
+    for (size_t i = from; i < n; i++) {
+        const Point p = v.at(i);
+        const double d = rightOf(a, dir, p);
+        const double along = dir.x * p.x + dir.y * p.y;
+        if (farther(d, along, best)) {
+            best = { i, d, along };
+        }
+    }
+}
+
+template <class View>
+SideCounts classifyTail(const View& v, size_t from, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+    SideCounts counts = { 0, 0 };
+    for (size_t i = from; i < n; i++) {
+        const double o = orient2d(a, b, v.at(i));
+        side[i] = o < 0 ? -1 : o > 0 ? 1 : 0;
+        counts.right += o < 0;
+        counts.left += o > 0;
+    }
+    return counts;
+}
+
+template <class View>
+size_t outsideTail(const View& v, size_t from, size_t n, const Point* poly, size_t k, uint8_t* keep)
+{
+    size_t kept = 0;
+    for (size_t i = from; i < n; i++) {
+        const bool inside = strictlyInside(v.at(i), poly, k);
+        keep[i] = !inside;
+        kept += !inside;
+    }
+    return kept;
+}
+
+template <class View>
+void extremesTail(const View& v, size_t from, size_t n, size_t& min, size_t& max)
+{
+    Point pmin = v.at(min), pmax = v.at(max);
+    for (size_t i = from; i < n; i++) {
+        const Point p = v.at(i);
+        if (lessXY(p, pmin)) { min = i; pmin = p; }
+        if (lessXY(pmax, p)) { max = i; pmax = p; }
+    }
+}
+
+template <class View>
+void argmaxDotTail(const View& v, size_t from, size_t n, const Point& d, size_t& best)
+{
+    const Point pb = v.at(best);
+    double bestDot = pb.x * d.x + pb.y * d.y;
+    for (size_t i = from; i < n; i++) {
+        const Point p = v.at(i);
+        const double s = p.x * d.x + p.y * d.y;
+        if (s > bestDot) {
+            bestDot = s;
+            best = i;
+        }
+    }
+}
+
+/*Folds per-lane results into one, lanes that never took a point hold index
+* -1. Equal candidates go to the lowest index so the answer matches a
+* front to back scan.
+*/
+void reduceFarthest(const double* dist, const double* along, const double* index, int lanes, Farthest& best)
+{
+    bool taken = false;
+    for (int k = 0; k < lanes; k++) {
+        if (index[k] < 0) {
+            continue;
+        }
+        const size_t at = (size_t)index[k];
+        if (!taken || farther(dist[k], along[k], best) ||
+            (dist[k] == best.dist && along[k] == best.along && at < best.at)) {
+            best = { at, dist[k], along[k] };
+            taken = true;
+        }
+    }
+}
+
+void reduceExtremes(const double* x, const double* y, const double* index, int lanes, bool lowest, size_t& out)
+{
+    Point best = { x[0], y[0] };
+    out = (size_t)index[0];
+    for (int k = 1; k < lanes; k++) {
+        const Point p = { x[k], y[k] };
+        const size_t at = (size_t)index[k];
+        const bool beats = lowest ? lessXY(p, best) : lessXY(best, p);
+        if (beats || (p == best && at < out)) {
+            best = p;
+            out = at;
+        }
+    }
+}
+
+void reduceArgmax(const double* dot, const double* index, int lanes, size_t& out)
+{
+    double best = dot[0];
+    out = (size_t)index[0];
+    for (int k = 1; k < lanes; k++) {
+        const size_t at = (size_t)index[k];
+        if (dot[k] > best || (dot[k] == best && at < out)) {
+            best = dot[k];
+            out = at;
+        }
+    }
+}
+
+//0x01 in byte k for every bit k of a nibble
+const uint32_t nibbleBytes[16] = {
+    0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+    0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101,
+};
+
+const uint8_t nibbleCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+#if GEOM_SIMD_X86
+
+//---- AVX2, 4 points per step
+
+template <size_t Stride>
+struct StridedAvx2 : Strided
+{
+    GEOM_AVX2 void load(size_t i, __m256d& x, __m256d& y) const
+    {
+        const double* p = xy + i * Stride;
+        const __m256d lo = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(p)), _mm_loadu_pd(p + 2 * Stride), 1);
+        const __m256d hi = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(p + Stride)), _mm_loadu_pd(p + 3 * Stride), 1);
+        x = _mm256_unpacklo_pd(lo, hi);
+        y = _mm256_unpackhi_pd(lo, hi);
+    }
+};
+
+struct SplitAvx2 : Split<double>
+{
+    GEOM_AVX2 void load(size_t i, __m256d& vx, __m256d& vy) const
+    {
+        vx = _mm256_loadu_pd(x + i);
+        vy = _mm256_loadu_pd(y + i);
+    }
+};
+
+struct SplitFloatAvx2 : Split<float>
+{
+    GEOM_AVX2 void load(size_t i, __m256d& vx, __m256d& vy) const
+    {
+        vx = _mm256_cvtps_pd(_mm_loadu_ps(x + i));
+        vy = _mm256_cvtps_pd(_mm_loadu_ps(y + i));
+    }
+};
+
+template <class L>
+GEOM_AVX2 Farthest farthestAvx2(const L& l, size_t n, const Point& a, const Point& b)
+{
+    const Point dir = b - a;
+    const __m256d ax = _mm256_set1_pd(a.x), ay = _mm256_set1_pd(a.y);
+    const __m256d dx = _mm256_set1_pd(dir.x), dy = _mm256_set1_pd(dir.y);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d bestD = _mm256_setzero_pd(), bestAlong = _mm256_setzero_pd();
+    __m256d bestI = _mm256_set1_pd(-1.0);
+    __m256d index = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y;
+        l.load(i, x, y);
+        const __m256d d = _mm256_sub_pd(_mm256_mul_pd(dy, _mm256_sub_pd(x, ax)), _mm256_mul_pd(dx, _mm256_sub_pd(y, ay)));
+        const __m256d along = _mm256_add_pd(_mm256_mul_pd(dx, x), _mm256_mul_pd(dy, y));
+        const __m256d take = _mm256_or_pd(_mm256_cmp_pd(d, bestD, _CMP_GT_OQ),
+            _mm256_and_pd(_mm256_cmp_pd(d, bestD, _CMP_EQ_OQ), _mm256_cmp_pd(along, bestAlong, _CMP_GT_OQ)));
+        bestD = _mm256_blendv_pd(bestD, d, take);
+        bestAlong = _mm256_blendv_pd(bestAlong, along, take);
+        bestI = _mm256_blendv_pd(bestI, index, take);
+        index = _mm256_add_pd(index, step);
+    }
+
+    double ds[4], as[4], is[4];
+    _mm256_storeu_pd(ds, bestD);
+    _mm256_storeu_pd(as, bestAlong);
+    _mm256_storeu_pd(is, bestI);
+    Farthest best = { 0, 0, 0 };
+    reduceFarthest(ds, as, is, 4, best);
+    farthestTail(l, i, n, a, b, best);
+    return best;
+}
+
+template <class L>
+GEOM_AVX2 SideCounts classifyAvx2(const L& l, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+    const Point dir = b - a;
+    const __m256d ax = _mm256_set1_pd(a.x), ay = _mm256_set1_pd(a.y);
+    const __m256d dx = _mm256_set1_pd(dir.x), dy = _mm256_set1_pd(dir.y);
+    const __m256d zero = _mm256_setzero_pd(), sign = _mm256_set1_pd(-0.0);
+    const __m256d errorBound = _mm256_set1_pd(detail::orientBound);
+    SideCounts counts = { 0, 0 };
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y;
+        l.load(i, x, y);
+        const __m256d left = _mm256_mul_pd(dx, _mm256_sub_pd(y, ay));
+        const __m256d right = _mm256_mul_pd(dy, _mm256_sub_pd(x, ax));
+        const __m256d o = _mm256_sub_pd(left, right);
+        const __m256d bound = _mm256_mul_pd(errorBound, _mm256_add_pd(_mm256_andnot_pd(sign, left), _mm256_andnot_pd(sign, right)));
+        int neg = _mm256_movemask_pd(_mm256_cmp_pd(o, zero, _CMP_LT_OQ));
+        int pos = _mm256_movemask_pd(_mm256_cmp_pd(o, zero, _CMP_GT_OQ));
+        const int unsure = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign, o), bound, _CMP_LT_OQ));
+        if (unsure) {
+            for (int k = 0; k < 4; k++) {
+                if (unsure & (1 << k)) {
+                    const double e = orient2d(a, b, l.at(i + k));
+                    neg = (neg & ~(1 << k)) | (e < 0) << k;
+                    pos = (pos & ~(1 << k)) | (e > 0) << k;
+                }
+            }
+        }
+        const uint32_t bytes = nibbleBytes[pos] | nibbleBytes[neg] * 0xFF;
+        std::memcpy(side + i, &bytes, 4);
+        counts.right += nibbleCount[neg];
+        counts.left += nibbleCount[pos];
+    }
+    const SideCounts tail = classifyTail(l, i, n, a, b, side);
+    return { counts.right + tail.right, counts.left + tail.left };
+}
+
+template <class L>
+GEOM_AVX2 size_t outsideAvx2(const L& l, size_t n, const Point* poly, size_t k, uint8_t* keep)
+{
+    const __m256d zero = _mm256_setzero_pd(), sign = _mm256_set1_pd(-0.0);
+    const __m256d errorBound = _mm256_set1_pd(detail::orientBound);
+    size_t kept = 0;
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y;
+        l.load(i, x, y);
+        __m256d inside = _mm256_cmp_pd(zero, zero, _CMP_EQ_OQ);
+        __m256d unsure = zero;
+        for (size_t j = 0; j < k; j++) {
+            const Point& a = poly[j];
+            const Point dir = poly[j + 1 == k ? 0 : j + 1] - a;
+            const __m256d left = _mm256_mul_pd(_mm256_set1_pd(dir.x), _mm256_sub_pd(y, _mm256_set1_pd(a.y)));
+            const __m256d right = _mm256_mul_pd(_mm256_set1_pd(dir.y), _mm256_sub_pd(x, _mm256_set1_pd(a.x)));
+            const __m256d o = _mm256_sub_pd(left, right);
+            const __m256d bound = _mm256_mul_pd(errorBound, _mm256_add_pd(_mm256_andnot_pd(sign, left), _mm256_andnot_pd(sign, right)));
+            inside = _mm256_and_pd(inside, _mm256_cmp_pd(o, zero, _CMP_GT_OQ));
+            unsure = _mm256_or_pd(unsure, _mm256_cmp_pd(_mm256_andnot_pd(sign, o), bound, _CMP_LT_OQ));
+        }
+        int out = ~_mm256_movemask_pd(inside) & 15;
+        const int recheck = _mm256_movemask_pd(unsure);
+        for (int m = 0; m < 4; m++) {
+            if (recheck & (1 << m)) {
+                out = (out & ~(1 << m)) | !strictlyInside(l.at(i + m), poly, k) << m;
+            }
+        }
+        std::memcpy(keep + i, &nibbleBytes[out], 4);
+        kept += nibbleCount[out];
+    }
+    return kept + outsideTail(l, i, n, poly, k, keep);
+}
+
+template <class L>
+GEOM_AVX2 void extremesAvx2(const L& l, size_t n, size_t& min, size_t& max)
+{
+    if (n < 4) {
+        min = max = 0;
+        extremesTail(l, 1, n, min, max);
+        return;
+    }
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d index = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    __m256d minX, minY;
+    l.load(0, minX, minY);
+    __m256d maxX = minX, maxY = minY, minI = index, maxI = index;
+
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y;
+        l.load(i, x, y);
+        index = _mm256_add_pd(index, step);
+        const __m256d lower = _mm256_or_pd(_mm256_cmp_pd(x, minX, _CMP_LT_OQ),
+            _mm256_and_pd(_mm256_cmp_pd(x, minX, _CMP_EQ_OQ), _mm256_cmp_pd(y, minY, _CMP_LT_OQ)));
+        const __m256d higher = _mm256_or_pd(_mm256_cmp_pd(x, maxX, _CMP_GT_OQ),
+            _mm256_and_pd(_mm256_cmp_pd(x, maxX, _CMP_EQ_OQ), _mm256_cmp_pd(y, maxY, _CMP_GT_OQ)));
+        minX = _mm256_blendv_pd(minX, x, lower);
+        minY = _mm256_blendv_pd(minY, y, lower);
+        minI = _mm256_blendv_pd(minI, index, lower);
+        maxX = _mm256_blendv_pd(maxX, x, higher);
+        maxY = _mm256_blendv_pd(maxY, y, higher);
+        maxI = _mm256_blendv_pd(maxI, index, higher);
+    }
+
+    double xs[4], ys[4], is[4];
+    _mm256_storeu_pd(xs, minX);
+    _mm256_storeu_pd(ys, minY);
+    _mm256_storeu_pd(is, minI);
+    reduceExtremes(xs, ys, is, 4, true, min);
+    _mm256_storeu_pd(xs, maxX);
+    _mm256_storeu_pd(ys, maxY);
+    _mm256_storeu_pd(is, maxI);
+    reduceExtremes(xs, ys, is, 4, false, max);
+    extremesTail(l, i, n, min, max);
+}
+
+template <class L>
+GEOM_AVX2 size_t argmaxDotAvx2(const L& l, size_t n, const Point& d)
+{
+    size_t best = 0;
+    if (n < 4) {
+        argmaxDotTail(l, 1, n, d, best);
+        return best;
+    }
+    const __m256d dx = _mm256_set1_pd(d.x), dy = _mm256_set1_pd(d.y);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d index = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    __m256d x, y;
+    l.load(0, x, y);
+    __m256d bestDot = _mm256_add_pd(_mm256_mul_pd(x, dx), _mm256_mul_pd(y, dy));
+    __m256d bestI = index;
+
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        l.load(i, x, y);
+        index = _mm256_add_pd(index, step);
+        const __m256d s = _mm256_add_pd(_mm256_mul_pd(x, dx), _mm256_mul_pd(y, dy));
+        const __m256d take = _mm256_cmp_pd(s, bestDot, _CMP_GT_OQ);
+        bestDot = _mm256_blendv_pd(bestDot, s, take);
+        bestI = _mm256_blendv_pd(bestI, index, take);
+    }
+
+    double ds[4], is[4];
+    _mm256_storeu_pd(ds, bestDot);
+    _mm256_storeu_pd(is, bestI);
+    reduceArgmax(ds, is, 4, best);
+    argmaxDotTail(l, i, n, d, best);
+    return best;
+}
+
+template <size_t K, class L>
+GEOM_AVX2 void argmaxDotsAvx2(const L& l, size_t n, const Point* d, size_t* best)
+{
+    if (n < 4) {
+        for (size_t k = 0; k < K; k++) {
+            best[k] = 0;
+            argmaxDotTail(l, 1, n, d[k], best[k]);
+        }
+        return;
+    }
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d index = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    __m256d dx[K], dy[K], bestDot[K], bestI[K];
+    __m256d x, y;
+    l.load(0, x, y);
+    for (size_t k = 0; k < K; k++) {
+        dx[k] = _mm256_set1_pd(d[k].x);
+        dy[k] = _mm256_set1_pd(d[k].y);
+        bestDot[k] = _mm256_add_pd(_mm256_mul_pd(x, dx[k]), _mm256_mul_pd(y, dy[k]));
+        bestI[k] = index;
+    }
+
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        l.load(i, x, y);
+        index = _mm256_add_pd(index, step);
+        for (size_t k = 0; k < K; k++) {
+            const __m256d s = _mm256_add_pd(_mm256_mul_pd(x, dx[k]), _mm256_mul_pd(y, dy[k]));
+            const __m256d take = _mm256_cmp_pd(s, bestDot[k], _CMP_GT_OQ);
+            bestDot[k] = _mm256_blendv_pd(bestDot[k], s, take);
+            bestI[k] = _mm256_blendv_pd(bestI[k], index, take);
+        }
+    }
+
+    for (size_t k = 0; k < K; k++) {
+        double ds[4], is[4];
+        _mm256_storeu_pd(ds, bestDot[k]);
+        _mm256_storeu_pd(is, bestI[k]);
+        reduceArgmax(ds, is, 4, best[k]);
+        argmaxDotTail(l, i, n, d[k], best[k]);
+    }
+}
+
+//---- AVX-512, 8 points per step
+
+template <size_t Stride>
+struct StridedAvx512;
+
+template <>
+struct StridedAvx512<2> : Strided
+{
+    GEOM_AVX512 void load(size_t i, __m512d& x, __m512d& y) const
+    {
+        const __m512d lo = _mm512_loadu_pd(xy + 2 * i);
+        const __m512d hi = _mm512_loadu_pd(xy + 2 * i + 8);
+        x = _mm512_permutex2var_pd(lo, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), hi);
+        y = _mm512_permutex2var_pd(lo, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), hi);
+    }
+};
+
+//records of three doubles, a Point and a 64 bit index
+template <>
+struct StridedAvx512<3> : Strided
+{
+    GEOM_AVX512 void load(size_t i, __m512d& x, __m512d& y) const
+    {
+        const double* p = xy + 3 * i;
+        const __m512d r0 = _mm512_loadu_pd(p);
+        const __m512d r1 = _mm512_loadu_pd(p + 8);
+        const __m512d r2 = _mm512_loadu_pd(p + 16);
+        const __m512d x01 = _mm512_permutex2var_pd(r0, _mm512_setr_epi64(0, 3, 6, 9, 12, 15, 0, 0), r1);
+        const __m512d y01 = _mm512_permutex2var_pd(r0, _mm512_setr_epi64(1, 4, 7, 10, 13, 0, 0, 0), r1);
+        x = _mm512_permutex2var_pd(x01, _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 10, 13), r2);
+        y = _mm512_permutex2var_pd(y01, _mm512_setr_epi64(0, 1, 2, 3, 4, 8, 11, 14), r2);
+    }
+};
+
+struct SplitAvx512 : Split<double>
+{
+    GEOM_AVX512 void load(size_t i, __m512d& vx, __m512d& vy) const
+    {
+        vx = _mm512_loadu_pd(x + i);
+        vy = _mm512_loadu_pd(y + i);
+    }
+};
+
+struct SplitFloatAvx512 : Split<float>
+{
+    GEOM_AVX512 void load(size_t i, __m512d& vx, __m512d& vy) const
+    {
+        vx = _mm512_cvtps_pd(_mm256_loadu_ps(x + i));
+        vy = _mm512_cvtps_pd(_mm256_loadu_ps(y + i));
+    }
+};
+
+template <class L>
+GEOM_AVX512 Farthest farthestAvx512(const L& l, size_t n, const Point& a, const Point& b)
+{
+    const Point dir = b - a;
+    const __m512d ax = _mm512_set1_pd(a.x), ay = _mm512_set1_pd(a.y);
+    const __m512d dx = _mm512_set1_pd(dir.x), dy = _mm512_set1_pd(dir.y);
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d bestD = _mm512_setzero_pd(), bestAlong = _mm512_setzero_pd();
+    __m512d bestI = _mm512_set1_pd(-1.0);
+    __m512d index = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d x, y;
+        l.load(i, x, y);
+        const __m512d d = _mm512_sub_pd(_mm512_mul_pd(dy, _mm512_sub_pd(x, ax)), _mm512_mul_pd(dx, _mm512_sub_pd(y, ay)));
+        const __m512d along = _mm512_add_pd(_mm512_mul_pd(dx, x), _mm512_mul_pd(dy, y));
+        const __mmask8 tie = _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(d, bestD, _CMP_EQ_OQ), along, bestAlong, _CMP_GT_OQ);
+        const __mmask8 take = _mm512_cmp_pd_mask(d, bestD, _CMP_GT_OQ) | tie;
+        bestD = _mm512_mask_blend_pd(take, bestD, d);
+        bestAlong = _mm512_mask_blend_pd(take, bestAlong, along);
+        bestI = _mm512_mask_blend_pd(take, bestI, index);
+        index = _mm512_add_pd(index, step);
+    }
+
+    double ds[8], as[8], is[8];
+    _mm512_storeu_pd(ds, bestD);
+    _mm512_storeu_pd(as, bestAlong);
+    _mm512_storeu_pd(is, bestI);
+    Farthest best = { 0, 0, 0 };
+    reduceFarthest(ds, as, is, 8, best);
+    farthestTail(l, i, n, a, b, best);
+    return best;
+}
+
+template <class L>
+GEOM_AVX512 SideCounts classifyAvx512(const L& l, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+    const Point dir = b - a;
+    const __m512d ax = _mm512_set1_pd(a.x), ay = _mm512_set1_pd(a.y);
+    const __m512d dx = _mm512_set1_pd(dir.x), dy = _mm512_set1_pd(dir.y);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d errorBound = _mm512_set1_pd(detail::orientBound);
+    SideCounts counts = { 0, 0 };
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d x, y;
+        l.load(i, x, y);
+        const __m512d left = _mm512_mul_pd(dx, _mm512_sub_pd(y, ay));
+        const __m512d right = _mm512_mul_pd(dy, _mm512_sub_pd(x, ax));
+        const __m512d o = _mm512_sub_pd(left, right);
+        const __m512d bound = _mm512_mul_pd(errorBound, _mm512_add_pd(_mm512_abs_pd(left), _mm512_abs_pd(right)));
+        unsigned neg = _mm512_cmp_pd_mask(o, zero, _CMP_LT_OQ);
+        unsigned pos = _mm512_cmp_pd_mask(o, zero, _CMP_GT_OQ);
+        const unsigned unsure = _mm512_cmp_pd_mask(_mm512_abs_pd(o), bound, _CMP_LT_OQ);
+        if (unsure) {
+            for (unsigned k = 0; k < 8; k++) {
+                if (unsure & (1u << k)) {
+                    const double e = orient2d(a, b, l.at(i + k));
+                    neg = (neg & ~(1u << k)) | (unsigned)(e < 0) << k;
+                    pos = (pos & ~(1u << k)) | (unsigned)(e > 0) << k;
+                }
+            }
+        }
+        const uint32_t low = nibbleBytes[pos & 15] | nibbleBytes[neg & 15] * 0xFF;
+        const uint32_t high = nibbleBytes[pos >> 4] | nibbleBytes[neg >> 4] * 0xFF;
+        std::memcpy(side + i, &low, 4);
+        std::memcpy(side + i + 4, &high, 4);
+        counts.right += nibbleCount[neg & 15] + nibbleCount[neg >> 4];
+        counts.left += nibbleCount[pos & 15] + nibbleCount[pos >> 4];
+    }
+    const SideCounts tail = classifyTail(l, i, n, a, b, side);
+    return { counts.right + tail.right, counts.left + tail.left };
+}
+
+template <class L>
+GEOM_AVX512 size_t outsideAvx512(const L& l, size_t n, const Point* poly, size_t k, uint8_t* keep)
+{
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d errorBound = _mm512_set1_pd(detail::orientBound);
+    size_t kept = 0;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d x, y;
+        l.load(i, x, y);
+        __mmask8 inside = 0xFF, unsure = 0;
+        for (size_t j = 0; j < k; j++) {
+            const Point& a = poly[j];
+            const Point dir = poly[j + 1 == k ? 0 : j + 1] - a;
+            const __m512d left = _mm512_mul_pd(_mm512_set1_pd(dir.x), _mm512_sub_pd(y, _mm512_set1_pd(a.y)));
+            const __m512d right = _mm512_mul_pd(_mm512_set1_pd(dir.y), _mm512_sub_pd(x, _mm512_set1_pd(a.x)));
+            const __m512d o = _mm512_sub_pd(left, right);
+            const __m512d bound = _mm512_mul_pd(errorBound, _mm512_add_pd(_mm512_abs_pd(left), _mm512_abs_pd(right)));
+            inside = _mm512_mask_cmp_pd_mask(inside, o, zero, _CMP_GT_OQ);
+            unsure |= _mm512_cmp_pd_mask(_mm512_abs_pd(o), bound, _CMP_LT_OQ);
+        }
+        unsigned out = ~inside & 0xFFu;
+        for (unsigned m = 0; m < 8; m++) {
+            if (unsure & (1u << m)) {
+                out = (out & ~(1u << m)) | (unsigned)!strictlyInside(l.at(i + m), poly, k) << m;
+            }
+        }
+        std::memcpy(keep + i, &nibbleBytes[out & 15], 4);
+        std::memcpy(keep + i + 4, &nibbleBytes[out >> 4], 4);
+        kept += nibbleCount[out & 15] + nibbleCount[out >> 4];
+    }
+    return kept + outsideTail(l, i, n, poly, k, keep);
+}
+
+template <class L>
+GEOM_AVX512 void extremesAvx512(const L& l, size_t n, size_t& min, size_t& max)
+{
+    if (n < 8) {
+        min = max = 0;
+        extremesTail(l, 1, n, min, max);
+        return;
+    }
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d index = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+    __m512d minX, minY;
+    l.load(0, minX, minY);
+    __m512d maxX = minX, maxY = minY, minI = index, maxI = index;
+
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m512d x, y;
+        l.load(i, x, y);
+        index = _mm512_add_pd(index, step);
+        const __mmask8 lower = _mm512_cmp_pd_mask(x, minX, _CMP_LT_OQ) |
+            _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(x, minX, _CMP_EQ_OQ), y, minY, _CMP_LT_OQ);
+        const __mmask8 higher = _mm512_cmp_pd_mask(x, maxX, _CMP_GT_OQ) |
+            _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(x, maxX, _CMP_EQ_OQ), y, maxY, _CMP_GT_OQ);
+        minX = _mm512_mask_blend_pd(lower, minX, x);
+        minY = _mm512_mask_blend_pd(lower, minY, y);
+        minI = _mm512_mask_blend_pd(lower, minI, index);
+        maxX = _mm512_mask_blend_pd(higher, maxX, x);
+        maxY = _mm512_mask_blend_pd(higher, maxY, y);
+        maxI = _mm512_mask_blend_pd(higher, maxI, index);
+    }
+
+    double xs[8], ys[8], is[8];
+    _mm512_storeu_pd(xs, minX);
+    _mm512_storeu_pd(ys, minY);
+    _mm512_storeu_pd(is, minI);
+    reduceExtremes(xs, ys, is, 8, true, min);
+    _mm512_storeu_pd(xs, maxX);
+    _mm512_storeu_pd(ys, maxY);
+    _mm512_storeu_pd(is, maxI);
+    reduceExtremes(xs, ys, is, 8, false, max);
+    extremesTail(l, i, n, min, max);
+}
+
+template <class L>
+GEOM_AVX512 size_t argmaxDotAvx512(const L& l, size_t n, const Point& d)
+{
+    size_t best = 0;
+    if (n < 8) {
+        argmaxDotTail(l, 1, n, d, best);
+        return best;
+    }
+    const __m512d dx = _mm512_set1_pd(d.x), dy = _mm512_set1_pd(d.y);
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d index = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+    __m512d x, y;
+    l.load(0, x, y);
+    __m512d bestDot = _mm512_add_pd(_mm512_mul_pd(x, dx), _mm512_mul_pd(y, dy));
+    __m512d bestI = index;
+
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        l.load(i, x, y);
+        index = _mm512_add_pd(index, step);
+        const __m512d s = _mm512_add_pd(_mm512_mul_pd(x, dx), _mm512_mul_pd(y, dy));
+        const __mmask8 take = _mm512_cmp_pd_mask(s, bestDot, _CMP_GT_OQ);
+        bestDot = _mm512_mask_blend_pd(take, bestDot, s);
+        bestI = _mm512_mask_blend_pd(take, bestI, index);
+    }
+
+    double ds[8], is[8];
+    _mm512_storeu_pd(ds, bestDot);
+    _mm512_storeu_pd(is, bestI);
+    reduceArgmax(ds, is, 8, best);
+    argmaxDotTail(l, i, n, d, best);
+    return best;
+}
+
+template <size_t K, class L>
+GEOM_AVX512 void argmaxDotsAvx512(const L& l, size_t n, const Point* d, size_t* best)
+{
+    if (n < 8) {
+        for (size_t k = 0; k < K; k++) {
+            best[k] = 0;
+            argmaxDotTail(l, 1, n, d[k], best[k]);
+        }
+        return;
+    }
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d index = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+    __m512d dx[K], dy[K], bestDot[K], bestI[K];
+    __m512d x, y;
+    l.load(0, x, y);
+    for (size_t k = 0; k < K; k++) {
+        dx[k] = _mm512_set1_pd(d[k].x);
+        dy[k] = _mm512_set1_pd(d[k].y);
+        bestDot[k] = _mm512_add_pd(_mm512_mul_pd(x, dx[k]), _mm512_mul_pd(y, dy[k]));
+        bestI[k] = index;
+    }
+
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        l.load(i, x, y);
+        index = _mm512_add_pd(index, step);
+        for (size_t k = 0; k < K; k++) {
+            const __m512d s = _mm512_add_pd(_mm512_mul_pd(x, dx[k]), _mm512_mul_pd(y, dy[k]));
+            const __mmask8 take = _mm512_cmp_pd_mask(s, bestDot[k], _CMP_GT_OQ);
+            bestDot[k] = _mm512_mask_blend_pd(take, bestDot[k], s);
+            bestI[k] = _mm512_mask_blend_pd(take, bestI[k], index);
+        }
+    }
+
+    for (size_t k = 0; k < K; k++) {
+        double ds[8], is[8];
+        _mm512_storeu_pd(ds, bestDot[k]);
+        _mm512_storeu_pd(is, bestI[k]);
+        reduceArgmax(ds, is, 8, best[k]);
+        argmaxDotTail(l, i, n, d[k], best[k]);
+    }
+}
+
+#endif
+
+Level detect()
+{
+#if GEOM_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return Level::Scalar;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return Level::Scalar;
+    }
+    //the OS has to save the wider registers too
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6) {
+        return Level::Avx512;
+    }
+    if ((info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6) {
+        return Level::Avx2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Level::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Level::Avx2;
+    }
+#endif
+#endif
+    return Level::Scalar;
+}
+
+//-1 until setLevel() is called
+std::atomic<int> forced(-1);
+
+}
+
+Level detected()
+{
+    static const Level level = detect();
+    return level;
+}
+
+Level active()
+{
+    const int f = forced.load(std::memory_order_relaxed);
+    return f < 0 ? detected() : (Level)f;
+}
+
+void setLevel(Level level)
+{
+    forced.store((int)(level < detected() ? level : detected()), std::memory_order_relaxed);
+}
+
+const char* levelName(Level level)
+{
+    switch (level) {
+    case Level::Scalar: return "scalar";
+    case Level::Avx2:   return "avx2";
+    case Level::Avx512: return "avx512";
+    }
+    return "?";
+}
+
+/*Each entry point picks the widest version for the active level. Strided
+* input only has vector loads for the two record sizes in use (Point, and
+* Point plus an index), anything else runs the scalar loop.
+*/
+
+Farthest farthestRight(const double* xy, size_t stride, size_t n, const Point& a, const Point& b)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512 && stride == 2) return farthestAvx512(StridedAvx512<2>{ { xy, 2 } }, n, a, b);
+    if (level == Level::Avx512 && stride == 3) return farthestAvx512(StridedAvx512<3>{ { xy, 3 } }, n, a, b);
+    if (level >= Level::Avx2 && stride == 2) return farthestAvx2(StridedAvx2<2>{ { xy, 2 } }, n, a, b);
+    if (level >= Level::Avx2 && stride == 3) return farthestAvx2(StridedAvx2<3>{ { xy, 3 } }, n, a, b);
+#endif
+    Farthest best = { 0, 0, 0 };
+    farthestTail(Strided{ xy, stride }, 0, n, a, b, best);
+    return best;
+}
+
+Farthest farthestRight(const double* x, const double* y, size_t n, const Point& a, const Point& b)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512) return farthestAvx512(SplitAvx512{ { x, y } }, n, a, b);
+    if (level == Level::Avx2) return farthestAvx2(SplitAvx2{ { x, y } }, n, a, b);
+#endif
+    Farthest best = { 0, 0, 0 };
+    farthestTail(Split<double>{ x, y }, 0, n, a, b, best);
+    return best;
+}
+
+SideCounts classify(const double* xy, size_t stride, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512 && stride == 2) return classifyAvx512(StridedAvx512<2>{ { xy, 2 } }, n, a, b, side);
+    if (level == Level::Avx512 && stride == 3) return classifyAvx512(StridedAvx512<3>{ { xy, 3 } }, n, a, b, side);
+    if (level >= Level::Avx2 && stride == 2) return classifyAvx2(StridedAvx2<2>{ { xy, 2 } }, n, a, b, side);
+    if (level >= Level::Avx2 && stride == 3) return classifyAvx2(StridedAvx2<3>{ { xy, 3 } }, n, a, b, side);
+#endif
+    return classifyTail(Strided{ xy, stride }, 0, n, a, b, side);
+}
+
+SideCounts classify(const double* x, const double* y, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512) return classifyAvx512(SplitAvx512{ { x, y } }, n, a, b, side);
+    if (level == Level::Avx2) return classifyAvx2(SplitAvx2{ { x, y } }, n, a, b, side);
+#endif
+    return classifyTail(Split<double>{ x, y }, 0, n, a, b, side);
+}
+
+SideCounts classify(const float* x, const float* y, size_t n, const Point& a, const Point& b, int8_t* side)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512) return classifyAvx512(SplitFloatAvx512{ { x, y } }, n, a, b, side);
+    if (level == Level::Avx2) return classifyAvx2(SplitFloatAvx2{ { x, y } }, n, a, b, side);
+#endif
+    return classifyTail(Split<float>{ x, y }, 0, n, a, b, side);
+}
+
+void extremesXY(const double* xy, size_t stride, size_t n, size_t& min, size_t& max)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512 && stride == 2) return extremesAvx512(StridedAvx512<2>{ { xy, 2 } }, n, min, max);
+    if (level == Level::Avx512 && stride == 3) return extremesAvx512(StridedAvx512<3>{ { xy, 3 } }, n, min, max);
+    if (level >= Level::Avx2 && stride == 2) return extremesAvx2(StridedAvx2<2>{ { xy, 2 } }, n, min, max);
+    if (level >= Level::Avx2 && stride == 3) return extremesAvx2(StridedAvx2<3>{ { xy, 3 } }, n, min, max);
+#endif
+    min = max = 0;
+    extremesTail(Strided{ xy, stride }, 1, n, min, max);
+}
+
+void extremesXY(const double* x, const double* y, size_t n, size_t& min, size_t& max)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512) return extremesAvx512(SplitAvx512{ { x, y } }, n, min, max);
+    if (level == Level::Avx2) return extremesAvx2(SplitAvx2{ { x, y } }, n, min, max);
+#endif
+    min = max = 0;
+    extremesTail(Split<double>{ x, y }, 1, n, min, max);
+}
+
+void extremesXY(const float* x, const float* y, size_t n, size_t& min, size_t& max)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512) return extremesAvx512(SplitFloatAvx512{ { x, y } }, n, min, max);
+    if (level == Level::Avx2) return extremesAvx2(SplitFloatAvx2{ { x, y } }, n, min, max);
+#endif
+    min = max = 0;
+    extremesTail(Split<float>{ x, y }, 1, n, min, max);
+}
+
+size_t outsideConvex(const double* xy, size_t stride, size_t n, const Point* poly, size_t k, uint8_t* keep)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512 && stride == 2) return outsideAvx512(StridedAvx512<2>{ { xy, 2 } }, n, poly, k, keep);
+    if (level == Level::Avx512 && stride == 3) return outsideAvx512(StridedAvx512<3>{ { xy, 3 } }, n, poly, k, keep);
+    if (level >= Level::Avx2 && stride == 2) return outsideAvx2(StridedAvx2<2>{ { xy, 2 } }, n, poly, k, keep);
+    if (level >= Level::Avx2 && stride == 3) return outsideAvx2(StridedAvx2<3>{ { xy, 3 } }, n, poly, k, keep);
+#endif
+    return outsideTail(Strided{ xy, stride }, 0, n, poly, k, keep);
+}
+
+size_t argmaxDot(const double* xy, size_t stride, size_t n, const Point& d)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512 && stride == 2) return argmaxDotAvx512(StridedAvx512<2>{ { xy, 2 } }, n, d);
+    if (level == Level::Avx512 && stride == 3) return argmaxDotAvx512(StridedAvx512<3>{ { xy, 3 } }, n, d);
+    if (level >= Level::Avx2 && stride == 2) return argmaxDotAvx2(StridedAvx2<2>{ { xy, 2 } }, n, d);
+    if (level >= Level::Avx2 && stride == 3) return argmaxDotAvx2(StridedAvx2<3>{ { xy, 3 } }, n, d);
+#endif
+    size_t best = 0;
+    argmaxDotTail(Strided{ xy, stride }, 1, n, d, best);
+    return best;
+}
+
+size_t argmaxDot(const double* x, const double* y, size_t n, const Point& d)
+{
+#if GEOM_SIMD_X86
+    const Level level = active();
+    if (level == Level::Avx512) return argmaxDotAvx512(SplitAvx512{ { x, y } }, n, d);
+    if (level == Level::Avx2) return argmaxDotAvx2(SplitAvx2{ { x, y } }, n, d);
+#endif
+    size_t best = 0;
+    argmaxDotTail(Split<double>{ x, y }, 1, n, d, best);
+    return best;
+}
+
+void argmaxDots(const double* xy, size_t stride, size_t n, const Point* d, size_t k, size_t* best)
+{
+#if GEOM_SIMD_X86
+    //the fixed counts let the compiler keep every direction in registers
+    const Level level = active();
+    if (stride == 2 && (k == 4 || k == 8)) {
+        const StridedAvx512<2> wide = { { xy, 2 } };
+        const StridedAvx2<2> narrow = { { xy, 2 } };
+        if (level == Level::Avx512) return k == 4 ? argmaxDotsAvx512<4>(wide, n, d, best) : argmaxDotsAvx512<8>(wide, n, d, best);
+        if (level == Level::Avx2) return k == 4 ? argmaxDotsAvx2<4>(narrow, n, d, best) : argmaxDotsAvx2<8>(narrow, n, d, best);
+    }
+#endif
+    for (size_t j = 0; j < k; j++) {
+        best[j] = argmaxDot(xy, stride, n, d[j]);
+    }
+}
+
+}
+}
@@ -0,0 +1,102 @@
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "geometry.h"
+
+namespace geom {
+namespace simd {
+
+/*Vectorized scans behind the hull engines.
+*
+* Every kernel exists as a scalar loop and, on x86, as AVX2 and AVX-512
+* versions. The widest one the CPU and OS support is picked on first use.
+* All versions do the same floating point operations in the same order (no
+* FMA), so they give bit-identical answers and the scalar loop stays the
+* reference.
+*
+* The side tests (classify, outsideConvex) are exact: lanes whose float
+* result is within the rounding error of zero are redone with orient2d().
+*
+* Points are read either interleaved, x at xy[i * stride] and y right after
+* it (a Point array is stride 2, any record that starts with a Point works),
+* or as separate x and y columns of double or float.
+*/
+enum class Level
+{
+    Scalar,
+    Avx2,
+    Avx512,
+};
+
+//best level this machine supports
+Level detected();
+
+//level the kernels currently run at, detected() unless overridden
+Level active();
+
+//forces a level for benchmarking, clamped to detected()
+void setLevel(Level level);
+
+const char* levelName(Level level);
+
+//point farthest to the right of a line, see farthestRight()
+struct Farthest
+{
+    size_t at;
+    double dist;    //-orient(a, b, p), so > 0 right of a->b
+    double along;   //dot(b - a, p), breaks ties
+};
+
+/*Point farthest to the right of a->b, ties going to the one furthest along
+* a->b. at is relative to the first point, 0 with dist 0 if no point is
+* right of the line.
+*/
+Farthest farthestRight(const double* xy, size_t stride, size_t n, const Point& a, const Point& b);
+Farthest farthestRight(const double* x, const double* y, size_t n, const Point& a, const Point& b);
+
+struct SideCounts
+{
+    size_t right;
+    size_t left;
+};
+
+/*Which side of a->b every point is on
+*
+* @param side: out, n entries of -1 (right, orient2d < 0), 1 (left) or 0 (on the line)
+*/
+SideCounts classify(const double* xy, size_t stride, size_t n, const Point& a, const Point& b, int8_t* side);
+SideCounts classify(const double* x, const double* y, size_t n, const Point& a, const Point& b, int8_t* side);
+SideCounts classify(const float* x, const float* y, size_t n, const Point& a, const Point& b, int8_t* side);
+
+//first lexicographically lowest and highest points (lessXY), n > 0
+void extremesXY(const double* xy, size_t stride, size_t n, size_t& min, size_t& max);
+void extremesXY(const double* x, const double* y, size_t n, size_t& min, size_t& max);
+void extremesXY(const float* x, const float* y, size_t n, size_t& min, size_t& max);
+
+/*Marks the points that are not strictly inside a convex polygon
+*
+* @param poly: k >= 3 vertices, counter-clockwise
+* @param keep: out, n entries of 1 (on or outside the polygon) or 0
+*
+* @return number of points kept
+*/
+size_t outsideConvex(const double* xy, size_t stride, size_t n, const Point* poly, size_t k, uint8_t* keep);
+
+//first point with the largest dot(p, d), n > 0
+size_t argmaxDot(const double* xy, size_t stride, size_t n, const Point& d);
+size_t argmaxDot(const double* x, const double* y, size_t n, const Point& d);
+
+/*argmaxDot() for k directions in one pass over the points, for scans that
+* are bound by memory rather than by the arithmetic
+*
+* @param best: out, k indices
+*/
+void argmaxDots(const double* xy, size_t stride, size_t n, const Point* d, size_t k, size_t* best);
+
+}
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "slidingwindow.h"
+
+namespace geom {
+
+SlidingWindowHull::SlidingWindowHull(size_t maxPoints, double maxAge) : limit(maxPoints), age(maxAge)
+{
+}
+
+void SlidingWindowHull::setLimits(size_t maxPoints, double maxAge)
+{
+    limit = maxPoints;
+    age = maxAge;
+    if (!window.empty()) {
+        evict(window.back().time, nullptr);
+    }
+}
+
+void SlidingWindowHull::push(const Point& p, double time, size_t id, std::vector<size_t>* evicted)
+{
+    window.push_back({ p, time, id });
+    dynamic.insert(p, id);
+    evict(time, evicted);
+}
+
+void SlidingWindowHull::expire(double now, std::vector<size_t>* evicted)
+{
+    evict(now, evicted);
+}
+
+//drops the oldest points while the window is too long or they are too old
+void SlidingWindowHull::evict(double now, std::vector<size_t>* evicted)
+{
+    while (!window.empty() && (window.size() > limit || now - window.front().time > age)) {
+        const Arrival& a = window.front();
+        dynamic.erase(a.p, a.id);
+        if (evicted) {
+            evicted->push_back(a.id);
+        }
+        window.pop_front();
+    }
+}
+
+void SlidingWindowHull::clear()
+{
+    window.clear();
+    dynamic.clear();
+}
+
+}
@@ -0,0 +1,81 @@
+#ifndef _SLIDINGWINDOW_H
+#define _SLIDINGWINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+#include "dynamic.h"
+#include "geometry.h"
+
+namespace geom {
+
+/*Convex hull of the last points of a timestamped stream
+*
+* The window is the last maxPoints points, of those only the ones at most
+* maxAge older than the newest. Points enter and leave a DynamicHull in
+* arrival order, so each point costs one insert and one erase, O(log^2 n)
+* amortized per arrival however many points one arrival evicts. The hull
+* size and extreme points are read off its root in O(1).
+*/
+class SlidingWindowHull
+{
+public:
+    explicit SlidingWindowHull(size_t maxPoints = SIZE_MAX,
+                               double maxAge = std::numeric_limits<double>::infinity());
+
+    SlidingWindowHull(const SlidingWindowHull&) = delete;
+    SlidingWindowHull& operator=(const SlidingWindowHull&) = delete;
+
+    //evicts right away if the window shrinks
+    void setLimits(size_t maxPoints, double maxAge);
+
+    /*Adds p, then evicts the points that fell out of the window
+    *
+    * @param time: arrival time, never less than the last one
+    * @param id: reported back by vertices() and evicted
+    * @param evicted: if given, the ids of the evicted points are appended, oldest first
+    */
+    void push(const Point& p, double time, size_t id, std::vector<size_t>* evicted = nullptr);
+
+    //evicts what is older than maxAge at now, for streams that go quiet
+    void expire(double now, std::vector<size_t>* evicted = nullptr);
+
+    void clear();
+
+    //points in the window
+    size_t size() const { return window.size(); }
+    bool   empty() const { return window.empty(); }
+
+    //hull vertices, same as DynamicHull's
+    size_t              hullSize() const { return dynamic.hullSize(); }
+    std::vector<size_t> vertices() const { return dynamic.vertices(); }
+    std::vector<Point>  vertexPoints() const { return dynamic.vertexPoints(); }
+
+    //extreme points of a non-empty window, see DynamicHull::leftmost()
+    const Point& leftmost() const { return dynamic.leftmost(); }
+    const Point& rightmost() const { return dynamic.rightmost(); }
+    const Point& bottom() const { return dynamic.bottom(); }
+    const Point& top() const { return dynamic.top(); }
+
+private:
+    struct Arrival
+    {
+        Point  p;
+        double time;
+        size_t id;
+    };
+
+    void evict(double now, std::vector<size_t>* evicted);
+
+    size_t              limit;
+    double              age;
+    std::deque<Arrival> window;
+    DynamicHull         dynamic;
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "spatialgrid.h"
+
+#include <algorithm>
+
+namespace geom {
+
+void SpatialGrid::insert(uint64_t id, float x, float y, float radius)
+{
+    const uint64_t cell = key(cellOf(x), cellOf(y));
+    entries[id] = cell;
+    cells[cell].push_back(id);
+    maxRadius = std::max(maxRadius, radius);
+}
+
+void SpatialGrid::unlink(uint64_t id, uint64_t cell)
+{
+    auto c = cells.find(cell);
+    std::vector<uint64_t>& members = c->second;
+    for (size_t i = 0; i < members.size(); i++) {
+        if (members[i] == id) {
+            members[i] = members.back();
+            members.pop_back();
+            break;
+        }
+    }
+    if (members.empty()) {
+        cells.erase(c);
+    }
+}
+
+void SpatialGrid::move(uint64_t id, float x, float y)
+{
+    auto e = entries.find(id);
+    if (e == entries.end()) {
+        return;
+    }
+    const uint64_t cell = key(cellOf(x), cellOf(y));
+    if (cell == e->second) {
+        return;
+    }
+    unlink(id, e->second);
+    e->second = cell;
+    cells[cell].push_back(id);
+}
+
+void SpatialGrid::remove(uint64_t id)
+{
+    auto e = entries.find(id);
+    if (e == entries.end()) {
+        return;
+    }
+    unlink(id, e->second);
+    entries.erase(e);
+}
+
+void SpatialGrid::clear()
+{
+    cells.clear();
+    entries.clear();
+    maxRadius = 0;
+}
+
+}
@@ -0,0 +1,85 @@
+#ifndef _SPATIALGRID_H
+#define _SPATIALGRID_H
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace geom {
+
+/*Uniform grid over point centers for picking
+*
+* Each entry sits in the one cell that holds its center. A query looks at
+* every cell within the largest radius inserted so far of the query point,
+* which is a 2x2 block as long as the cell size is at least twice that
+* radius. Moving an entry only touches the grid when it changes cell.
+*
+* pick() returns the hit the caller ranks highest, asking for the rank at
+* query time, so a z-order that changes under the grid (such as a dense
+* index that an erase elsewhere moves) never goes stale in it.
+*/
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = 32.0f) : cellSize(cellSize), maxRadius(0) {}
+
+    void insert(uint64_t id, float x, float y, float radius);
+    void move(uint64_t id, float x, float y);
+    void remove(uint64_t id);
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+    /*Highest-ranked entry near (x, y) for which hit(id) is true
+    *
+    * @param hit: exact test, only called for entries in nearby cells
+    * @param rank: the entry's z-order, hit() is skipped for entries ranked
+    *              below the best hit so far
+    * @return true and the id in found if anything was hit
+    */
+    template <class F, class R>
+    bool pick(float x, float y, F hit, R rank, uint64_t& found) const
+    {
+        bool any = false;
+        uint64_t best = 0;
+        const int64_t x0 = cellOf(x - maxRadius), x1 = cellOf(x + maxRadius);
+        const int64_t y0 = cellOf(y - maxRadius), y1 = cellOf(y + maxRadius);
+        for (int64_t cy = y0; cy <= y1; cy++) {
+            for (int64_t cx = x0; cx <= x1; cx++) {
+                auto cell = cells.find(key(cx, cy));
+                if (cell == cells.end()) {
+                    continue;
+                }
+                for (uint64_t id : cell->second) {
+                    const uint64_t r = rank(id);
+                    if ((!any || r > best) && hit(id)) {
+                        any = true;
+                        best = r;
+                        found = id;
+                    }
+                }
+            }
+        }
+        return any;
+    }
+
+private:
+    int64_t cellOf(float v) const { return static_cast<int64_t>(std::floor(v / cellSize)); }
+
+    static uint64_t key(int64_t cx, int64_t cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    void unlink(uint64_t id, uint64_t cell);
+
+    float                                               cellSize;
+    float                                               maxRadius;
+    std::unordered_map<uint64_t, std::vector<uint64_t>> cells;
+    std::unordered_map<uint64_t, uint64_t>              entries;    //cell of each id
+};
+
+}
+
+#endif
@@ -0,0 +1,248 @@
+#include "stream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "hull.h"
+#include "pointfile.h"
+
+namespace geom {
+
+namespace {
+
+bool failWith(std::string* error, const std::string& what)
+{
+    if (error) {
+        *error = what;
+    }
+    return false;
+}
+
+inline bool isSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',';
+}
+
+bool seekTo(FILE* f, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(f, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+uint64_t fileLength(FILE* f)
+{
+#ifdef _WIN32
+    if (_fseeki64(f, 0, SEEK_END) != 0) return 0;
+    return (uint64_t)_ftelli64(f);
+#else
+    if (fseeko(f, 0, SEEK_END) != 0) return 0;
+    return (uint64_t)ftello(f);
+#endif
+}
+
+//reads count values of T at offset into out as doubles
+template <class T>
+bool readColumn(FILE* f, uint64_t offset, size_t count, std::vector<T>& raw, double* out)
+{
+    raw.resize(count);
+    if (!seekTo(f, offset) || std::fread(raw.data(), sizeof(T), count, f) != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (double)raw[i];
+    }
+    return true;
+}
+
+}
+
+StreamingHull::StreamingHull(size_t chunkSize)
+    : chunk(chunkSize ? chunkSize : 1)
+{
+}
+
+void StreamingHull::add(const Point& p)
+{
+    pending.push_back(p);
+    if (pending.size() >= chunk) {
+        merge();
+    }
+}
+
+void StreamingHull::add(const Point* pts, size_t n)
+{
+    while (n > 0) {
+        const size_t take = std::min(n, chunk - pending.size());
+        pending.insert(pending.end(), pts, pts + take);
+        pts += take;
+        n -= take;
+        if (pending.size() >= chunk) {
+            merge();
+        }
+    }
+}
+
+void StreamingHull::flush()
+{
+    if (!pending.empty()) {
+        merge();
+    }
+}
+
+void StreamingHull::clear()
+{
+    hull.clear();
+    hullIndex.clear();
+    pending.clear();
+    seen = 0;
+}
+
+void StreamingHull::merge()
+{
+    //old hull first, then the chunk, so buffer positions map back to stream positions
+    const size_t old = hull.size();
+    std::vector<Point> work;
+    work.reserve(old + pending.size());
+    work.insert(work.end(), hull.begin(), hull.end());
+    work.insert(work.end(), pending.begin(), pending.end());
+
+    std::vector<Point> nextHull;
+    std::vector<uint64_t> nextIndex;
+    for (size_t i : quickHull(work.data(), work.size())) {
+        nextHull.push_back(work[i]);
+        nextIndex.push_back(i < old ? hullIndex[i] : seen + (i - old));
+    }
+    hull.swap(nextHull);
+    hullIndex.swap(nextIndex);
+    seen += pending.size();
+    pending.clear();
+}
+
+bool streamHull(FILE* in, StreamFormat format, StreamingHull& hull, std::string* error)
+{
+    const size_t block = 1 << 16;
+
+    if (format == StreamFormat::Interleaved64) {
+        std::vector<double> raw(2 * block);
+        std::vector<Point> pts(block);
+        size_t got;
+        while ((got = std::fread(raw.data(), sizeof(double), raw.size(), in)) > 0) {
+            for (size_t i = 0; i + 1 < got; i += 2) {
+                pts[i / 2] = { raw[i], raw[i + 1] };
+            }
+            hull.add(pts.data(), got / 2);
+            if (got % 2 != 0) {
+                return failWith(error, "the stream ends in the middle of a point");
+            }
+        }
+    }
+    else {
+        //text is parsed a block at a time, a number cut off at the end of a block
+        //is moved to the front and completed by the next read
+        std::vector<char> text(block + 1);
+        size_t kept = 0;
+        double coord[2];
+        int have = 0;
+        for (;;) {
+            const size_t got = std::fread(text.data() + kept, 1, block - kept, in);
+            const bool last = got == 0;
+            char* at = text.data();
+            char* end = text.data() + kept + got;
+            *end = '\0';
+            for (;;) {
+                while (at < end && isSeparator(*at)) at++;
+                if (at == end) {
+                    kept = 0;
+                    break;
+                }
+                //a token touching the end of the block may continue in the next read
+                char* tokenEnd = at;
+                while (tokenEnd < end && !isSeparator(*tokenEnd)) tokenEnd++;
+                if (tokenEnd == end && !last) {
+                    kept = (size_t)(end - at);
+                    if (kept == block) {
+                        return failWith(error, "a token is longer than the read buffer");
+                    }
+                    std::memmove(text.data(), at, kept);
+                    break;
+                }
+                char* parsed;
+                const double v = std::strtod(at, &parsed);
+                if (parsed != tokenEnd) {
+                    return failWith(error, "not a number: " + std::string(at, tokenEnd));
+                }
+                coord[have++] = v;
+                if (have == 2) {
+                    hull.add({ coord[0], coord[1] });
+                    have = 0;
+                }
+                at = tokenEnd;
+            }
+            if (last) {
+                if (have != 0) {
+                    return failWith(error, "the stream ends in the middle of a point");
+                }
+                break;
+            }
+        }
+    }
+
+    if (std::ferror(in)) {
+        return failWith(error, "read error");
+    }
+    hull.flush();
+    return true;
+}
+
+bool streamPointFile(const char* path, StreamingHull& hull, std::string* error)
+{
+    FILE* f = std::fopen(path, "rb");
+    if (!f) {
+        return failWith(error, std::string("cannot open ") + path);
+    }
+
+    PointFileHeader header;
+    const uint64_t length = fileLength(f);
+    bool ok = length >= sizeof(header) && seekTo(f, 0) && std::fread(&header, sizeof(header), 1, f) == 1;
+    const char* problem = ok ? checkPointFileHeader(header, length) : " is too short to be a point file";
+    if (problem) {
+        std::fclose(f);
+        return failWith(error, std::string(path) + problem);
+    }
+
+    const size_t block = 1 << 16;
+    std::vector<float> raw32;
+    std::vector<double> raw64;
+    std::vector<double> xs(block), ys(block);
+    std::vector<Point> pts(block);
+    for (uint64_t done = 0; ok && done < header.count; done += block) {
+        const size_t count = (size_t)std::min<uint64_t>(block, header.count - done);
+        const uint64_t skip = done * header.scalar;
+        if (header.scalar == (uint32_t)Scalar::Float32) {
+            ok = readColumn(f, header.xOffset + skip, count, raw32, xs.data()) &&
+                readColumn(f, header.yOffset + skip, count, raw32, ys.data());
+        }
+        else {
+            ok = readColumn(f, header.xOffset + skip, count, raw64, xs.data()) &&
+                readColumn(f, header.yOffset + skip, count, raw64, ys.data());
+        }
+        for (size_t i = 0; ok && i < count; i++) {
+            pts[i] = { xs[i], ys[i] };
+        }
+        if (ok) {
+            hull.add(pts.data(), count);
+        }
+    }
+    std::fclose(f);
+    if (!ok) {
+        return failWith(error, std::string("read error in ") + path);
+    }
+    hull.flush();
+    return true;
+}
+
+}
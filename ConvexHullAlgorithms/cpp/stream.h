@@ -0,0 +1,76 @@
+#ifndef _STREAM_H
+#define _STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+/*Convex hull of a point stream in bounded memory
+*
+* Points are buffered into chunks. Each full chunk is hulled together with
+* the running hull (hull(hull(A) + B) = hull(A + B)), and only the hull
+* vertices are kept afterwards. Memory stays O(h + chunk) however many
+* points go through.
+*/
+class StreamingHull
+{
+public:
+    explicit StreamingHull(size_t chunkSize = 1 << 20);
+
+    void add(const Point& p);
+    void add(const Point* pts, size_t n);
+
+    //hulls whatever is still buffered, vertices() is only complete after this
+    void flush();
+
+    //running hull as of the last flush or full chunk, same order as quickHull()
+    const std::vector<Point>&    vertices() const { return hull; }
+    //position in the stream of every vertex, counted from 0
+    const std::vector<uint64_t>& indices() const { return hullIndex; }
+
+    //points added so far
+    uint64_t count() const { return seen; }
+
+    void clear();
+
+private:
+    void merge();
+
+    size_t                chunk;
+    std::vector<Point>    hull;
+    std::vector<uint64_t> hullIndex;
+    std::vector<Point>    pending;
+    uint64_t              seen = 0;
+};
+
+enum class StreamFormat
+{
+    Text,               //"x y" pairs separated by any whitespace, e.g. from another program
+    Interleaved64,      //raw native float64 x, y, x, y, ...
+};
+
+/*Feeds a whole stream into hull, reading one chunk at a time, and flushes it
+*
+* Works on pipes (no seeking). Stops at end of input or at the first token
+* of a text stream that is not a number.
+*
+* @return false on a read error or malformed input, error says which
+*/
+bool streamHull(FILE* in, StreamFormat format, StreamingHull& hull, std::string* error = nullptr);
+
+/*Feeds a point file (see pointfile.h) into hull without mapping it
+*
+* The two columns are read in step, a chunk of each at a time, so files
+* larger than memory work as well.
+*/
+bool streamPointFile(const char* path, StreamingHull& hull, std::string* error = nullptr);
+
+}
+
+#endif
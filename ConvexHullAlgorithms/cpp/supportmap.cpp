@@ -0,0 +1,79 @@
+#include "supportmap.h"
+
+#include "simd.h"
+
+namespace geom {
+
+namespace {
+
+//below this many vertices a scan beats the binary search
+const size_t scanLimit = 16;
+
+//0 for directions in [0, pi), 1 for [pi, 2*pi), as minkowskiSum() splits them
+inline int halfPlane(const Point& v)
+{
+    return (v.y > 0 || (v.y == 0 && v.x > 0)) ? 0 : 1;
+}
+
+//whether direction e comes strictly before direction t counter-clockwise from angle 0
+inline bool turnsBefore(const Point& e, const Point& t)
+{
+    const int he = halfPlane(e), ht = halfPlane(t);
+    return he != ht ? he < ht : cross(e, t) > 0;
+}
+
+}
+
+SupportMap::SupportMap() : start(0)
+{
+}
+
+SupportMap::SupportMap(const Point* pts, size_t n) : start(0)
+{
+    build(pts, n);
+}
+
+void SupportMap::build(const Point* pts, size_t n)
+{
+    vertices.assign(pts, pts + n);
+    edges.clear();
+    start = 0;
+    if (n <= scanLimit) {
+        return;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if (pts[i].y < pts[start].y || (pts[i].y == pts[start].y && pts[i].x < pts[start].x)) {
+            start = i;
+        }
+    }
+    edges.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        const size_t from = (start + i) % n;
+        const size_t to = from + 1 == n ? 0 : from + 1;
+        edges[i] = pts[to] - pts[from];
+    }
+}
+
+size_t SupportMap::extreme(const Point& d) const
+{
+    const size_t n = vertices.size();
+    if (edges.empty()) {
+        return simd::argmaxDot(&vertices[0].x, 2, n, d);
+    }
+
+    //the first edge not turned before d rotated by 90 degrees leaves the extreme vertex
+    const Point t = { -d.y, d.x };
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (turnsBefore(edges[mid], t)) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return (start + lo) % n;
+}
+
+}
@@ -0,0 +1,49 @@
+#ifndef _SUPPORTMAP_H
+#define _SUPPORTMAP_H
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+
+namespace geom {
+
+/*Support function of a convex polygon in O(log h)
+*
+* Walking a counter-clockwise polygon from its bottom-most vertex, the edge
+* directions turn monotonically through one full circle. The vertex
+* furthest along d is where they cross d turned by 90 degrees, so a binary
+* search over the edges finds it instead of a scan over every vertex. The
+* edge directions are compared by half plane and cross product, with no
+* angles computed. Small polygons are still scanned, which is faster there.
+*
+* Building the map is O(h) and it keeps its own copy of the vertices, so
+* build it once per hull and query it as often as the hull stays the same.
+*/
+class SupportMap
+{
+public:
+    SupportMap();
+
+    /*@param pts: vertices of a convex polygon counter-clockwise with no
+    *            collinear vertices, as quickHull() returns them
+    */
+    SupportMap(const Point* pts, size_t n);
+    void build(const Point* pts, size_t n);
+
+    //index into the vertices given to build() of one furthest along d, n must be > 0
+    size_t extreme(const Point& d) const;
+
+    const Point* points() const { return vertices.data(); }
+    size_t       size() const { return vertices.size(); }
+    bool         empty() const { return vertices.empty(); }
+
+private:
+    std::vector<Point> vertices;   //as given
+    std::vector<Point> edges;      //edge i leaves vertex (start + i) % n
+    size_t             start;      //the bottom-most vertex, lowest y then lowest x
+};
+
+}
+
+#endif
@@ -0,0 +1,1540 @@
+/*Tests for the geometry core
+*
+* Every hull engine is compared against a plain monotone chain on exact
+* predicates, over inputs picked to break float geometry: points collinear
+* up to rounding, collinear lines with 1e-12 jitter, Kettner's 0.5 + k ulp
+* grid, repeated points and lattices with many points on the hull edges.
+* The predicates themselves are checked against 128-bit integer arithmetic.
+* The engines with SIMD kernels run at every level the CPU has.
+*
+* hulltest [name ...]
+*
+* With names only the tests whose name contains one of them run. Prints one
+* line per failed check and exits with 1 if there was any.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "broadphase.h"
+#include "dischull.h"
+#include "dispatch.h"
+#include "dynamic.h"
+#include "gjk.h"
+#include "hull.h"
+#include "kinetic.h"
+#include "minkowski.h"
+#include "pointfile.h"
+#include "pointgen.h"
+#include "predicates.h"
+#include "simd.h"
+#include "slidingwindow.h"
+#include "spatialgrid.h"
+#include "stream.h"
+#include "supportmap.h"
+#include "threadpool.h"
+
+using namespace geom;
+
+namespace {
+
+size_t failures = 0;
+const char* current = "";
+
+void check(bool ok, const char* what, size_t detail = 0)
+{
+    if (!ok) {
+        if (failures < 50) {
+            std::printf("FAIL %s: %s (%zu)\n", current, what, detail);
+        }
+        failures++;
+    }
+}
+
+//splitmix64, so a seed gives the same cases everywhere
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    //uniform in [0, 1)
+    double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    //uniform in [lo, hi]
+    int64_t range(int64_t lo, int64_t hi) { return lo + (int64_t)(next() % (uint64_t)(hi - lo + 1)); }
+};
+
+int sign(double v) { return (v > 0) - (v < 0); }
+int sign(__int128 v) { return (v > 0) - (v < 0); }
+
+/*Reference hull: Andrew's monotone chain on orient2d(), counter-clockwise
+* from the lowest-x (then lowest-y) point with no collinear vertices
+*/
+std::vector<Point> referenceHull(const Point* pts, size_t n)
+{
+    std::vector<Point> sorted(pts, pts + n);
+    std::sort(sorted.begin(), sorted.end(), lessXY);
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    if (sorted.size() < 2) {
+        return sorted;
+    }
+    std::vector<Point> hull;
+    for (size_t pass = 0; pass < 2; pass++) {
+        const size_t start = hull.size();
+        for (const Point& p : sorted) {
+            while (hull.size() >= start + 2 && orient2d(hull[hull.size() - 2], hull.back(), p) <= 0) {
+                hull.pop_back();
+            }
+            hull.push_back(p);
+        }
+        hull.pop_back();
+        std::reverse(sorted.begin(), sorted.end());
+    }
+    return hull;
+}
+
+bool sameHull(const Point* pts, const std::vector<size_t>& hull, const std::vector<Point>& expected)
+{
+    if (hull.size() != expected.size()) {
+        return false;
+    }
+    for (size_t k = 0; k < hull.size(); k++) {
+        if (pts[hull[k]] != expected[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//the hull's points in quickHull()'s order
+std::vector<Point> hullPoints(const Point* pts, size_t n)
+{
+    std::vector<Point> out;
+    for (size_t i : quickHull(pts, n)) {
+        out.push_back(pts[i]);
+    }
+    return out;
+}
+
+//---- inputs --------------------------------------------------------------
+
+//points on a long line, each rounded to the nearest double so almost none is exactly on it
+std::vector<Point> roundedLine(Random& r, size_t n)
+{
+    const Point a = { r.unit() * 100, r.unit() * 100 };
+    const Point b = { a.x + 1 + r.unit() * 1e6, a.y + r.unit() * 1e6 };
+    std::vector<Point> pts(n);
+    for (Point& p : pts) {
+        const double t = r.unit();
+        p = { a.x + t * (b.x - a.x), a.y + t * (b.y - a.y) };
+    }
+    return pts;
+}
+
+//a line with every point moved by up to 1e-12
+std::vector<Point> jitteredLine(Random& r, size_t n)
+{
+    std::vector<Point> pts = roundedLine(r, n);
+    for (Point& p : pts) {
+        p.x += (r.unit() - 0.5) * 2e-12;
+        p.y += (r.unit() - 0.5) * 2e-12;
+    }
+    return pts;
+}
+
+//Kettner et al.'s grid near (0.5, 0.5) with one ulp spacing, plus two points on y = x
+std::vector<Point> ulpGrid(Random& r, size_t n)
+{
+    const double u = std::ldexp(1.0, -53);
+    std::vector<Point> pts(n);
+    for (Point& p : pts) {
+        p = { 0.5 + r.range(0, 255) * u, 0.5 + r.range(0, 255) * u };
+    }
+    if (n >= 2) {
+        pts[0] = { 12, 12 };
+        pts[1] = { 24, 24 };
+    }
+    return pts;
+}
+
+//a few distinct points, each repeated many times
+std::vector<Point> repeated(Random& r, size_t n)
+{
+    std::vector<Point> distinct(1 + r.range(0, 6));
+    for (Point& p : distinct) {
+        p = { (double)r.range(-3, 3), (double)r.range(-3, 3) };
+    }
+    std::vector<Point> pts(n);
+    for (Point& p : pts) {
+        p = distinct[r.range(0, distinct.size() - 1)];
+    }
+    return pts;
+}
+
+//a small integer lattice scaled by an odd step, so the hull edges are full of points
+std::vector<Point> lattice(Random& r, size_t n)
+{
+    const double step = 0.1 * (1 + 2 * r.range(0, 10));
+    std::vector<Point> pts(n);
+    for (Point& p : pts) {
+        p = { r.range(0, 12) * step, r.range(0, 12) * step };
+    }
+    return pts;
+}
+
+std::vector<Point> uniform(Random& r, size_t n)
+{
+    return generatePoints(Distribution::UniformDisk, n, r.next());
+}
+
+typedef std::vector<Point> (*Input)(Random& r, size_t n);
+
+struct NamedInput
+{
+    const char* name;
+    Input       make;
+};
+
+const NamedInput inputs[] = {
+    { "rounded-line", roundedLine },
+    { "jittered-line", jitteredLine },
+    { "ulp-grid", ulpGrid },
+    { "repeated", repeated },
+    { "lattice", lattice },
+    { "uniform", uniform },
+};
+
+//---- predicates ----------------------------------------------------------
+
+void testOrientUlpGrid()
+{
+    //p left of (12, 12) -> (24, 24) exactly when it is above y = x
+    const double u = std::ldexp(1.0, -53);
+    const Point q = { 12, 12 }, r = { 24, 24 };
+    for (int i = 0; i < 256; i++) {
+        for (int j = 0; j < 256; j++) {
+            const Point p = { 0.5 + i * u, 0.5 + j * u };
+            const int expected = (j > i) - (j < i);
+            check(sign(orient2d(q, r, p)) == expected, "orient2d on the ulp grid", i * 256 + j);
+            check(sign(orient2d(p, q, r)) == expected, "orient2d on the ulp grid, rotated", i * 256 + j);
+        }
+    }
+}
+
+/*Integers up to about 2^50, so differences and products are exact in 128
+* bits but not in doubles. Every fourth case is exactly collinear.
+*/
+void testOrientNearCollinear()
+{
+    Random r(16);
+    const int64_t big = (int64_t)1 << 50;
+    for (size_t k = 0; k < 200000; k++) {
+        const int64_t ax = r.range(-big, big), ay = r.range(-big, big);
+        int64_t bx, by, cx, cy;
+        if (k % 4 == 0) {
+            //exactly collinear: a plus two multiples of a small step
+            const int64_t px = r.range(-(1 << 20), 1 << 20), py = r.range(-(1 << 20), 1 << 20);
+            const int64_t s = r.range(-(1 << 28), 1 << 28), t = r.range(-(1 << 28), 1 << 28);
+            bx = ax + s * px;
+            by = ay + s * py;
+            cx = ax + t * px;
+            cy = ay + t * py;
+        }
+        else {
+            bx = r.range(-big, big);
+            by = r.range(-big, big);
+            const double t = r.unit();
+            cx = (int64_t)std::llround(ax + t * (double)(bx - ax)) + r.range(-1, 1);
+            cy = (int64_t)std::llround(ay + t * (double)(by - ay)) + r.range(-1, 1);
+        }
+        const __int128 exact = (__int128)(ax - cx) * (by - cy) - (__int128)(ay - cy) * (bx - cx);
+        const Point a = { (double)ax, (double)ay }, b = { (double)bx, (double)by }, c = { (double)cx, (double)cy };
+        check(sign(orient2d(a, b, c)) == sign(exact), "orient2d near collinear", k);
+        check(sign(orient2d(b, c, a)) == sign(exact), "orient2d near collinear, rotated", k);
+        check(sign(orient2d(b, a, c)) == -sign(exact), "orient2d near collinear, swapped", k);
+    }
+}
+
+__int128 exactIncircle(const int64_t* x, const int64_t* y)
+{
+    __int128 det = 0;
+    for (int k = 0; k < 3; k++) {
+        const int64_t dx = x[k] - x[3], dy = y[k] - y[3];
+        const int64_t ex = x[(k + 1) % 3] - x[3], ey = y[(k + 1) % 3] - y[3];
+        const int64_t fx = x[(k + 2) % 3] - x[3], fy = y[(k + 2) % 3] - y[3];
+        det += ((__int128)dx * dx + (__int128)dy * dy) * ((__int128)ex * fy - (__int128)ey * fx);
+    }
+    return det;
+}
+
+/*Integer points on a circle of radius 65 scaled by an odd factor, so every
+* four are exactly cocircular but far from exact in doubles, then the same
+* with the fourth point moved one unit
+*/
+void testIncircleCocircular()
+{
+    const int base[][2] = { { 0, 65 }, { 16, 63 }, { 25, 60 }, { 33, 56 }, { 39, 52 }, { 52, 39 }, { 56, 33 }, { 60, 25 }, { 63, 16 }, { 65, 0 } };
+    std::vector<std::pair<int64_t, int64_t>> circle;
+    const int64_t scale = 12345, cx = 3000001, cy = -7000003;
+    for (const auto& b : base) {
+        for (int sx = -1; sx <= 1; sx += 2) {
+            for (int sy = -1; sy <= 1; sy += 2) {
+                circle.push_back({ cx + sx * b[0] * scale, cy + sy * b[1] * scale });
+            }
+        }
+    }
+    std::sort(circle.begin(), circle.end());
+    circle.erase(std::unique(circle.begin(), circle.end()), circle.end());
+
+    Random r(17);
+    for (size_t k = 0; k < 100000; k++) {
+        int64_t x[4], y[4];
+        Point p[4];
+        for (int i = 0; i < 4; i++) {
+            const auto& c = circle[r.range(0, circle.size() - 1)];
+            x[i] = c.first;
+            y[i] = c.second;
+        }
+        if (k % 2) {
+            x[3] += r.range(-1, 1);
+            y[3] += r.range(-1, 1);
+        }
+        for (int i = 0; i < 4; i++) {
+            p[i] = { (double)x[i], (double)y[i] };
+        }
+        const int expected = sign(exactIncircle(x, y));
+        if (k % 2 == 0) {
+            check(expected == 0, "exact reference finds the points cocircular", k);
+        }
+        check(sign(incircle(p[0], p[1], p[2], p[3])) == expected, "incircle near cocircular", k);
+        check(sign(incircle(p[1], p[2], p[0], p[3])) == expected, "incircle near cocircular, rotated", k);
+    }
+}
+
+void testIncircleRandom()
+{
+    Random r(18);
+    const int64_t big = (int64_t)1 << 22;
+    for (size_t k = 0; k < 100000; k++) {
+        int64_t x[4], y[4];
+        Point p[4];
+        for (int i = 0; i < 4; i++) {
+            x[i] = r.range(-big, big);
+            y[i] = r.range(-big, big);
+            p[i] = { (double)x[i], (double)y[i] };
+        }
+        check(sign(incircle(p[0], p[1], p[2], p[3])) == sign(exactIncircle(x, y)), "incircle random", k);
+    }
+}
+
+//---- hull engines --------------------------------------------------------
+
+std::vector<size_t> quickHullColumns(const Point* pts, size_t n)
+{
+    std::vector<double> x(n), y(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = pts[i].x;
+        y[i] = pts[i].y;
+    }
+    return quickHull(x.data(), y.data(), n);
+}
+
+struct Engine
+{
+    const char*  name;
+    HullFunction hull;
+};
+
+const Engine engines[] = {
+    { "quickHull", hullFunction<QuickHull>() },
+    { "quickHull columns", quickHullColumns },
+    { "quickHullParallel", hullFunction<ParallelQuickHull>() },
+    { "chanHull", hullFunction<ChanHull>() },
+    { "filtered quickHull", hullFunction<Filtered<QuickHull>>() },
+    { "filtered chanHull", hullFunction<Filtered<ChanHull>>() },
+};
+
+std::vector<simd::Level> levels()
+{
+    std::vector<simd::Level> all;
+    for (simd::Level l : { simd::Level::Scalar, simd::Level::Avx2, simd::Level::Avx512 }) {
+        if (l <= simd::detected()) {
+            all.push_back(l);
+        }
+    }
+    return all;
+}
+
+void testHullEngines()
+{
+    for (simd::Level level : levels()) {
+        simd::setLevel(level);
+        Random r(19);
+        for (const NamedInput& input : inputs) {
+            for (size_t k = 0; k < 300; k++) {
+                const size_t n = 1 + r.range(0, k < 200 ? 40 : 3000);
+                const std::vector<Point> pts = input.make(r, n);
+                const std::vector<Point> expected = referenceHull(pts.data(), n);
+                for (const Engine& e : engines) {
+                    const std::string what = std::string(e.name) + " on " + input.name + " at " + simd::levelName(level);
+                    check(sameHull(pts.data(), e.hull(pts.data(), n), expected), what.c_str(), k);
+                }
+            }
+        }
+    }
+    simd::setLevel(simd::detected());
+}
+
+//big enough that quickHullParallel() really splits the work
+void testParallelHull()
+{
+    TaskPool pool(4);
+    Random r(20);
+    for (const NamedInput& input : inputs) {
+        const size_t n = 300000;
+        const std::vector<Point> pts = input.make(r, n);
+        const std::string what = std::string("quickHullParallel on ") + input.name;
+        check(sameHull(pts.data(), quickHullParallel(pts.data(), n, pool), referenceHull(pts.data(), n)), what.c_str());
+    }
+}
+
+void testHullBatch()
+{
+    Random r(21);
+    for (const NamedInput& input : inputs) {
+        std::vector<Point> pts;
+        std::vector<size_t> offsets = { 0 };
+        for (size_t g = 0; g < 2000; g++) {
+            const size_t n = r.range(0, g % 50 == 0 ? 200 : 64);
+            const std::vector<Point> group = n ? input.make(r, n) : std::vector<Point>();
+            pts.insert(pts.end(), group.begin(), group.end());
+            offsets.push_back(pts.size());
+        }
+        const HullBatch batch = hullBatch(pts.data(), offsets.data(), offsets.size() - 1);
+        for (size_t g = 0; g + 1 < offsets.size(); g++) {
+            const std::vector<size_t> hull(batch.vertices.begin() + batch.offsets[g], batch.vertices.begin() + batch.offsets[g + 1]);
+            const std::vector<Point> expected = referenceHull(pts.data() + offsets[g], offsets[g + 1] - offsets[g]);
+            const std::string what = std::string("hullBatch on ") + input.name;
+            check(sameHull(pts.data(), hull, expected), what.c_str(), g);
+        }
+    }
+}
+
+/*Random drags on a KineticHull, hull vertices more often than not, checked
+* after every move
+*/
+//applies KineticHull's edits to a copy of its hull, as a caller following it does
+void replayEdits(std::vector<size_t>& hull, const std::vector<KineticHull::Edit>& edits, const std::vector<size_t>& chains)
+{
+    for (const KineticHull::Edit& e : edits) {
+        if (e.rotate) {
+            std::rotate(hull.begin(), hull.begin() + e.from, hull.end());
+            continue;
+        }
+        const size_t* chain = chains.data() + e.chain;
+        if (e.from < e.to) {
+            hull.erase(hull.begin() + e.from + 1, hull.begin() + e.to);
+            hull.insert(hull.begin() + e.from + 1, chain, chain + e.count);
+        }
+        else {
+            hull.erase(hull.begin() + e.from + 1, hull.end());
+            hull.erase(hull.begin(), hull.begin() + e.to);
+            hull.insert(hull.end(), chain, chain + e.count);
+        }
+    }
+}
+
+void testKineticMoves()
+{
+    Random r(22);
+    for (const NamedInput& input : inputs) {
+        for (size_t trial = 0; trial < 40; trial++) {
+            const size_t n = 4 + r.range(0, 300);
+            std::vector<Point> pts = input.make(r, n);
+            KineticHull kinetic;
+            kinetic.build(pts.data(), n, trial % 2 == 1);
+            std::vector<size_t> copy = kinetic.vertices();
+            std::vector<KineticHull::Edit> edits;
+            std::vector<size_t> chains;
+            kinetic.takeEdits(edits, chains);
+            const std::vector<Point> targets = input.make(r, 200);
+            for (size_t step = 0; step < targets.size(); step++) {
+                const std::vector<size_t>& hull = kinetic.vertices();
+                const size_t i = r.range(0, 2) != 0 && !hull.empty() ? hull[r.range(0, hull.size() - 1)] : r.range(0, n - 1);
+                pts[i] = targets[step];
+                kinetic.move(i, pts[i]);
+                const std::string what = std::string("KineticHull::move on ") + input.name;
+                check(sameHull(pts.data(), kinetic.vertices(), referenceHull(pts.data(), n)), what.c_str(), trial * 1000 + step);
+
+                //a copy kept in step by the edits must stay equal to the hull
+                if (kinetic.takeEdits(edits, chains)) {
+                    replayEdits(copy, edits, chains);
+                    check(copy == kinetic.vertices(), "KineticHull edits replay to the hull", trial * 1000 + step);
+                }
+                copy = kinetic.vertices();
+            }
+        }
+    }
+}
+
+/*Random inserts, erases and moves, with every position drawn from a small
+* pool of the input's points so duplicates and collinear runs pile up
+*/
+void testDynamicHull()
+{
+    Random r(23);
+    for (const NamedInput& input : inputs) {
+        for (size_t trial = 0; trial < 10; trial++) {
+            const std::vector<Point> pool = input.make(r, 8 + r.range(0, 56));
+            std::vector<Point> live;
+            std::vector<size_t> ids;
+            size_t nextId = 0;
+            DynamicHull dynamic;
+            for (size_t step = 0; step < 300; step++) {
+                const int64_t op = live.empty() ? 0 : r.range(0, 2);
+                const Point p = pool[r.range(0, pool.size() - 1)];
+                if (op == 0) {
+                    dynamic.insert(p, nextId);
+                    live.push_back(p);
+                    ids.push_back(nextId++);
+                }
+                else {
+                    const size_t k = r.range(0, live.size() - 1);
+                    if (op == 1) {
+                        check(dynamic.erase(live[k], ids[k]), "DynamicHull::erase finds the point", step);
+                        live[k] = live.back();
+                        ids[k] = ids.back();
+                        live.pop_back();
+                        ids.pop_back();
+                    }
+                    else {
+                        check(dynamic.move(live[k], p, ids[k]), "DynamicHull::move finds the point", step);
+                        live[k] = p;
+                    }
+                }
+
+                const std::vector<size_t> expected = quickHull(live.data(), live.size());
+                const std::vector<Point> got = dynamic.vertexPoints();
+                bool same = got.size() == expected.size() && dynamic.hullSize() == expected.size();
+                for (size_t v = 0; same && v < got.size(); v++) {
+                    same = got[v] == live[expected[v]];
+                }
+                //vertices() gives ids, each has to be a live point at its vertex
+                const std::vector<size_t> vertexIds = dynamic.vertices();
+                same = same && vertexIds.size() == got.size();
+                for (size_t v = 0; same && v < vertexIds.size(); v++) {
+                    const size_t k = std::find(ids.begin(), ids.end(), vertexIds[v]) - ids.begin();
+                    same = k < ids.size() && live[k] == got[v];
+                }
+                const std::string what = std::string("DynamicHull against quickHull on ") + input.name;
+                check(same, what.c_str(), trial * 1000 + step);
+                check(dynamic.size() == live.size(), "DynamicHull::size counts copies", step);
+                check(!dynamic.erase(p, nextId), "DynamicHull::erase of an unknown id fails", step);
+            }
+        }
+    }
+}
+
+/*Timestamped points pushed through windows of random size and age, with
+* the limits changed and the window expired now and then. The window is
+* always a suffix of the arrivals, so it is tracked by its first one and
+* checked after every eviction against quickHull of what is left in it
+*/
+void testSlidingWindow()
+{
+    Random r(38);
+    for (const NamedInput& input : inputs) {
+        for (size_t trial = 0; trial < 10; trial++) {
+            const std::vector<Point> pool = input.make(r, 8 + r.range(0, 56));
+            size_t maxPoints = 1 + r.range(0, 40);
+            double maxAge = 0.5 + r.unit() * 3;
+            SlidingWindowHull window(maxPoints, maxAge);
+            std::vector<Point> pts;
+            std::vector<double> times;
+            size_t first = 0;
+            double now = 0;
+            for (size_t step = 0; step < 400; step++) {
+                std::vector<size_t> evicted;
+                const int64_t op = r.range(0, 19);
+                if (op == 0) {
+                    maxPoints = 1 + r.range(0, 40);
+                    maxAge = 0.5 + r.unit() * 3;
+                    window.setLimits(maxPoints, maxAge);
+                }
+                else if (op == 1) {
+                    now += r.unit() * 2;
+                    window.expire(now, &evicted);
+                }
+                else {
+                    //equal timestamps are allowed, and common here
+                    now += r.range(0, 2) == 0 ? 0 : r.unit() * 0.2;
+                    pts.push_back(pool[r.range(0, pool.size() - 1)]);
+                    times.push_back(now);
+                    window.push(pts.back(), now, pts.size() - 1, &evicted);
+                }
+
+                //setLimits() has no time of its own, it measures age from the newest point
+                const double at = op == 0 && !pts.empty() ? times.back() : now;
+                const size_t before = first;
+                if (pts.size() - first > maxPoints) {
+                    first = pts.size() - maxPoints;
+                }
+                while (first < pts.size() && at - times[first] > maxAge) {
+                    first++;
+                }
+                if (op != 0) {
+                    std::vector<size_t> expectedEvicted;
+                    for (size_t i = before; i < first; i++) {
+                        expectedEvicted.push_back(i);
+                    }
+                    check(evicted == expectedEvicted, "SlidingWindowHull evicts the oldest points", trial * 1000 + step);
+                }
+
+                const std::vector<Point> live(pts.begin() + first, pts.end());
+                const std::vector<Point> expected = hullPoints(live.data(), live.size());
+                bool same = window.size() == live.size() && window.hullSize() == expected.size() && window.vertexPoints() == expected;
+                const std::vector<size_t> ids = window.vertices();
+                same = same && ids.size() == expected.size();
+                for (size_t v = 0; same && v < ids.size(); v++) {
+                    same = ids[v] >= first && ids[v] < pts.size() && pts[ids[v]] == expected[v];
+                }
+                if (same && !live.empty()) {
+                    const auto byYX = [](const Point& a, const Point& b) { return a.y < b.y || (a.y == b.y && a.x < b.x); };
+                    same = window.leftmost() == *std::min_element(live.begin(), live.end(), lessXY) &&
+                           window.rightmost() == *std::max_element(live.begin(), live.end(), lessXY) &&
+                           window.bottom() == *std::min_element(live.begin(), live.end(), byYX) &&
+                           window.top() == *std::max_element(live.begin(), live.end(), byYX);
+                }
+                const std::string what = std::string("SlidingWindowHull against quickHull of the window on ") + input.name;
+                check(same, what.c_str(), trial * 1000 + step);
+            }
+        }
+    }
+}
+
+//---- integer hulls -------------------------------------------------------
+
+int orientInt(const IntPoint& a, const IntPoint& b, const IntPoint& c)
+{
+    const __int128 d = (__int128)((int64_t)b.x - a.x) * ((int64_t)c.y - a.y) -
+                       (__int128)((int64_t)b.y - a.y) * ((int64_t)c.x - a.x);
+    return sign(d);
+}
+
+bool lessInt(const IntPoint& a, const IntPoint& b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+//referenceHull() on integers, every orientation exact in 128 bits
+std::vector<IntPoint> referenceIntHull(const IntPoint* pts, size_t n)
+{
+    std::vector<IntPoint> sorted(pts, pts + n);
+    std::sort(sorted.begin(), sorted.end(), lessInt);
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    if (sorted.size() < 2) {
+        return sorted;
+    }
+    std::vector<IntPoint> hull;
+    for (size_t pass = 0; pass < 2; pass++) {
+        const size_t start = hull.size();
+        for (const IntPoint& p : sorted) {
+            while (hull.size() >= start + 2 && orientInt(hull[hull.size() - 2], hull.back(), p) <= 0) {
+                hull.pop_back();
+            }
+            hull.push_back(p);
+        }
+        hull.pop_back();
+        std::reverse(sorted.begin(), sorted.end());
+    }
+    return hull;
+}
+
+/*Integer points within limit of the origin: the corners and edges of the
+* range, or runs on a long line with steep or shallow slope, some moved off
+* it by one unit, so every orientation is a difference of huge products
+*/
+std::vector<IntPoint> extremeIntPoints(Random& r, size_t n, int64_t limit)
+{
+    std::vector<IntPoint> pts(n);
+    if (r.range(0, 1) == 0) {
+        const int64_t near[] = { -limit, -limit + 1, -limit + 2, limit - 2, limit - 1, limit, 0 };
+        for (IntPoint& p : pts) {
+            const int64_t x = r.range(0, 3) == 0 ? r.range(-limit, limit) : near[r.range(0, 6)];
+            const int64_t y = r.range(0, 3) == 0 ? r.range(-limit, limit) : near[r.range(0, 6)];
+            p = { (int32_t)x, (int32_t)y };
+        }
+        return pts;
+    }
+    const int64_t dx = r.range(1, 1000), dy = r.range(-1000, 1000);
+    const int64_t steps = 2 * limit / std::max(dx, std::abs(dy)) - 2;
+    const int64_t x0 = -limit + 1, y0 = dy >= 0 ? -limit + 1 : limit - 1;
+    for (IntPoint& p : pts) {
+        const int64_t t = r.range(0, steps);
+        const int64_t jitter = r.range(0, 3) == 0 ? r.range(-1, 1) : 0;
+        const int64_t y = y0 + t * dy + jitter;
+        p = { (int32_t)(x0 + t * dx), (int32_t)std::max(-limit, std::min(limit, y)) };
+    }
+    return pts;
+}
+
+void testIntHull()
+{
+    Random r(36);
+    const int64_t limit = INT32_MAX;
+    for (size_t k = 0; k < 5000; k++) {
+        std::vector<IntPoint> pts = extremeIntPoints(r, 1 + r.range(0, 200), limit);
+        if (k % 10 == 0) {
+            pts.push_back({ INT32_MIN, INT32_MIN });
+            pts.push_back({ INT32_MIN, INT32_MAX });
+        }
+        const std::vector<size_t> hull = quickHull(pts.data(), pts.size());
+        const std::vector<IntPoint> expected = referenceIntHull(pts.data(), pts.size());
+        bool same = hull.size() == expected.size();
+        for (size_t v = 0; same && v < hull.size(); v++) {
+            same = pts[hull[v]] == expected[v];
+        }
+        check(same, "quickHull on extreme int32 points", k);
+    }
+}
+
+//minkowskiSum() needs |x|, |y| < 2^30 so every sum fits in an int32
+void testIntMinkowskiSum()
+{
+    Random r(37);
+    const int64_t limit = (1 << 30) - 1;
+    for (size_t k = 0; k < 3000; k++) {
+        const std::vector<IntPoint> cloudA = extremeIntPoints(r, 1 + r.range(0, 30), limit);
+        const std::vector<IntPoint> cloudB = extremeIntPoints(r, 1 + r.range(0, 30), limit);
+        const std::vector<IntPoint> a = referenceIntHull(cloudA.data(), cloudA.size());
+        const std::vector<IntPoint> b = referenceIntHull(cloudB.data(), cloudB.size());
+        std::vector<IntPoint> sums;
+        for (const IntPoint& p : a) {
+            for (const IntPoint& q : b) {
+                sums.push_back({ p.x + q.x, p.y + q.y });
+            }
+        }
+        const std::vector<IntPoint> expected = referenceIntHull(sums.data(), sums.size());
+        const std::vector<IntPoint> got = minkowskiSum(a.data(), a.size(), b.data(), b.size());
+
+        //the same cycle, the sum starts at its bottom-most vertex
+        bool same = got.size() == expected.size();
+        const size_t start = same && !got.empty() ? std::find(got.begin(), got.end(), expected[0]) - got.begin() : 0;
+        same = same && (got.empty() || start < got.size());
+        for (size_t v = 0; same && v < expected.size(); v++) {
+            same = got[(start + v) % got.size()] == expected[v];
+        }
+        check(same, "minkowskiSum on extreme int32 polygons", k);
+    }
+}
+
+//---- task pool -----------------------------------------------------------
+
+//a throwing task must reach the caller of wait() and leave the pool usable
+void testPoolException()
+{
+    TaskPool pool(4);
+    for (size_t k = 0; k < 200; k++) {
+        bool caught = false;
+        try {
+            pool.parallelFor(0, 1000, 10, [&](size_t lo, size_t) {
+                if (lo == 10 * (k % 100)) {
+                    throw std::runtime_error("task");
+                }
+            });
+        }
+        catch (const std::runtime_error&) {
+            caught = true;
+        }
+        check(caught, "exception from a task reaches wait()", k);
+    }
+    std::vector<int> done(1000, 0);
+    pool.parallelFor(0, done.size(), 10, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            done[i] = 1;
+        }
+    });
+    check(std::count(done.begin(), done.end(), 1) == 1000, "pool still runs every task after exceptions");
+}
+
+//---- disc hulls ----------------------------------------------------------
+
+double reach(const Disc& d, double t)
+{
+    return d.center.x * std::cos(t) + d.center.y * std::sin(t) + d.radius;
+}
+
+/*The arcs must run from 0 to 2 pi without gaps, and at the middle of each
+* its disc has to reach at least as far as every other disc
+*/
+bool validDiscHull(const std::vector<Disc>& discs, const DiscHull& hull)
+{
+    const std::vector<DiscArc>& arcs = hull.arcs();
+    if (arcs.empty() || arcs.front().from != 0 || arcs.back().to != 2 * 3.14159265358979323846) {
+        return false;
+    }
+    for (size_t k = 0; k < arcs.size(); k++) {
+        const DiscArc& arc = arcs[k];
+        if (!(arc.from < arc.to) || (k > 0 && arcs[k - 1].to != arc.from)) {
+            return false;
+        }
+        const double t = 0.5 * (arc.from + arc.to);
+        const double own = reach(discs[arc.disc], t);
+        for (const Disc& d : discs) {
+            if (reach(d, t) > own + 1e-9 * (1 + std::fabs(own))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//every arc of the hull is on disc
+bool onlyDisc(const DiscHull& hull, size_t disc)
+{
+    for (const DiscArc& arc : hull.arcs()) {
+        if (arc.disc != disc) {
+            return false;
+        }
+    }
+    return !hull.empty();
+}
+
+void testDiscHullContained()
+{
+    //a point on the circle of a bigger disc, tangent from inside at angle pi
+    const std::vector<Disc> tangent = { { { 0, 2 }, 0 }, { { 2, 2 }, 2 } };
+    check(onlyDisc(DiscHull(tangent.data(), 2), 1), "point on the circle of a bigger disc");
+    const std::vector<Disc> tangentSwapped = { tangent[1], tangent[0] };
+    check(onlyDisc(DiscHull(tangentSwapped.data(), 2), 0), "bigger disc first, point on its circle");
+
+    const std::vector<Disc> touching = { { { 1, 0 }, 1 }, { { 0, 0 }, 2 } };
+    check(onlyDisc(DiscHull(touching.data(), 2), 1), "disc tangent inside a bigger one");
+
+    const std::vector<Disc> nested = { { { 0.5, -0.25 }, 1 }, { { 0, 0 }, 3 } };
+    check(onlyDisc(DiscHull(nested.data(), 2), 1), "disc strictly inside a bigger one");
+
+    const std::vector<Disc> same = { { { 1, 1 }, 2 }, { { 1, 1 }, 2 }, { { 1, 1 }, 2 } };
+    check(onlyDisc(DiscHull(same.data(), 3), 0), "identical discs keep the first");
+
+    const std::vector<Disc> points = { { { 3, 4 }, 0 }, { { 3, 4 }, 0 } };
+    check(onlyDisc(DiscHull(points.data(), 2), 0), "identical points keep the first");
+}
+
+//small integer centers and radii, so tangencies and nesting are everywhere
+void testDiscHullGrid()
+{
+    Random r(24);
+    for (size_t k = 0; k < 20000; k++) {
+        std::vector<Disc> discs(1 + r.range(0, 6));
+        for (Disc& d : discs) {
+            d = { { (double)r.range(0, 4), (double)r.range(0, 4) }, (double)r.range(0, 3) };
+        }
+        check(validDiscHull(discs, DiscHull(discs.data(), discs.size())), "hull of grid discs", k);
+    }
+}
+
+/*The app ranks picks by the dense index of each point in its PointStore,
+* which an erase changes by moving the last point into the hole, so the
+* grid has to use the rank as it is when pick() runs
+*/
+void testPickRank()
+{
+    SpatialGrid grid(32);
+    std::vector<uint64_t> rank = { 0, 1, 2 };
+    for (uint64_t id = 0; id < rank.size(); id++) {
+        grid.insert(id, 10, 10, 5);
+    }
+    const auto everything = [](uint64_t) { return true; };
+    const auto byRank = [&](uint64_t id) { return rank[id]; };
+    uint64_t found = 99;
+    check(grid.pick(10, 10, everything, byRank, found) && found == 2, "pick takes the highest rank", found);
+
+    //erasing 1 moves 2 into its place
+    grid.remove(1);
+    rank[2] = 1;
+    rank.push_back(2);
+    grid.insert(3, 10, 10, 5);
+    check(grid.pick(10, 10, everything, byRank, found) && found == 3, "pick reads the rank when it runs", found);
+    check(grid.pick(12, 12, [](uint64_t id) { return id != 3; }, byRank, found) && found == 2, "pick skips misses", found);
+    check(!grid.pick(200, 200, everything, byRank, found), "pick far away");
+}
+
+//---- collision -----------------------------------------------------------
+
+const double infinity = std::numeric_limits<double>::infinity();
+
+//hull of 3 to 12 random integer points within size of c, at least a triangle
+std::vector<Point> randomPolygon(Random& r, const Point& c, int64_t size)
+{
+    for (;;) {
+        std::vector<Point> pts(3 + r.range(0, 9));
+        for (Point& p : pts) {
+            p = { c.x + r.range(-size, size), c.y + r.range(-size, size) };
+        }
+        const std::vector<Point> hull = referenceHull(pts.data(), pts.size());
+        if (hull.size() >= 3) {
+            return hull;
+        }
+    }
+}
+
+double segmentDistance(const Point& p, const Point& a, const Point& b)
+{
+    const Point ab = b - a;
+    const double t = std::max(0.0, std::min(1.0, dot(p - a, ab) / dot(ab, ab)));
+    const Point d = p - (a + t * ab);
+    return std::sqrt(dot(d, d));
+}
+
+//A - B as the hull of all n * m differences
+std::vector<Point> bruteDifference(const std::vector<Point>& a, const std::vector<Point>& b)
+{
+    std::vector<Point> d;
+    for (const Point& p : a) {
+        for (const Point& q : b) {
+            d.push_back(p - q);
+        }
+    }
+    return referenceHull(d.data(), d.size());
+}
+
+/*Least distance from the origin to the line of an edge of polygon d, over
+* every edge. Positive when the origin is inside, so for A - B it is the
+* penetration depth, and negative when it is outside
+*/
+double originDepth(const std::vector<Point>& d)
+{
+    double depth = infinity;
+    for (size_t i = 0; i < d.size(); i++) {
+        const Point& u = d[i];
+        const Point e = d[(i + 1) % d.size()] - u;
+        depth = std::min(depth, cross(e, Point{ 0, 0 } - u) / std::sqrt(dot(e, e)));
+    }
+    return depth;
+}
+
+//distance between two polygons that are apart, least over every vertex of one and edge of the other
+double pairDistance(const std::vector<Point>& a, const std::vector<Point>& b)
+{
+    double best = infinity;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t j = 0; j < b.size(); j++) {
+            best = std::min(best, segmentDistance(a[i], b[j], b[(j + 1) % b.size()]));
+            best = std::min(best, segmentDistance(b[j], a[i], a[(i + 1) % a.size()]));
+        }
+    }
+    return best;
+}
+
+//0 while they overlap
+double bruteDistance(const std::vector<Point>& a, const std::vector<Point>& b)
+{
+    return originDepth(bruteDifference(a, b)) >= 0 ? 0 : pairDistance(a, b);
+}
+
+//the same vertices in the same cyclic order, from any start
+bool sameCycle(const std::vector<Point>& got, const std::vector<Point>& expected)
+{
+    if (got.size() != expected.size()) {
+        return false;
+    }
+    if (got.empty()) {
+        return true;
+    }
+    const size_t start = std::find(got.begin(), got.end(), expected[0]) - got.begin();
+    for (size_t k = 0; k < expected.size(); k++) {
+        if (start == got.size() || got[(start + k) % got.size()] != expected[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool near(double got, double expected, double tolerance = 1e-9)
+{
+    return std::fabs(got - expected) <= tolerance * (1 + std::fabs(expected));
+}
+
+//a pair of polygons about 20 apart, overlapping in about half the cases
+void randomPair(Random& r, std::vector<Point>& a, std::vector<Point>& b)
+{
+    a = randomPolygon(r, { 0, 0 }, 1 + r.range(0, 20));
+    b = randomPolygon(r, { (double)r.range(-20, 20), (double)r.range(-20, 20) }, 1 + r.range(0, 20));
+}
+
+//integer coordinates make every difference exact, collinear edges included
+void testMinkowskiDifference()
+{
+    Random r(25);
+    std::vector<Point> a, b;
+    for (size_t k = 0; k < 5000; k++) {
+        randomPair(r, a, b);
+        const std::vector<Point> d = minkowskiDifference(a.data(), a.size(), b.data(), b.size());
+        check(sameCycle(d, bruteDifference(a, b)), "minkowskiDifference against all differences", k);
+    }
+}
+
+//depth against the nearest edge of A - B, and B moved by it has to only touch A
+void testEpaDepth()
+{
+    Random r(26);
+    std::vector<Point> a, b;
+    for (size_t k = 0; k < 5000; k++) {
+        randomPair(r, a, b);
+        const std::vector<Point> d = bruteDifference(a, b);
+        const double depth = originDepth(d);
+        const EpaResult e = epa(a.data(), a.size(), b.data(), b.size());
+        const SupportMap mapA(a.data(), a.size()), mapB(b.data(), b.size());
+        const EpaResult m = epa(mapA, mapB);
+        if (depth < -1e-9) {
+            check(!e.intersecting && e.depth == 0, "epa of apart polygons", k);
+            check(!m.intersecting && m.depth == 0, "epa through maps of apart polygons", k);
+            continue;
+        }
+        if (depth < 1e-9) {
+            continue;
+        }
+        check(e.intersecting && near(e.depth, depth), "epa depth against the edges of A - B", k);
+        check(m.intersecting && near(m.depth, depth), "epa depth through maps", k);
+        check(near(dot(e.normal, e.normal), 1), "epa normal is unit length", k);
+
+        //A - (B + v) is A - B moved by -v, which has to have the origin on its boundary
+        const Point v = e.depth * e.normal;
+        std::vector<Point> moved = d;
+        for (Point& p : moved) {
+            p = p - v;
+        }
+        check(std::fabs(originDepth(moved)) <= 1e-9 * (1 + depth), "B moved by epa only touches A", k);
+    }
+}
+
+void testGjkDistance()
+{
+    Random r(27);
+    std::vector<Point> a, b;
+    for (size_t k = 0; k < 5000; k++) {
+        randomPair(r, a, b);
+        const double depth = originDepth(bruteDifference(a, b));
+        const GjkResult g = gjk(a.data(), a.size(), b.data(), b.size());
+        const SupportMap mapA(a.data(), a.size()), mapB(b.data(), b.size());
+        const GjkResult m = gjk(mapA, mapB);
+        if (depth > 1e-9) {
+            check(g.intersecting && m.intersecting, "gjk of overlapping polygons", k);
+            continue;
+        }
+        if (depth > -1e-9) {
+            continue;
+        }
+        const double distance = pairDistance(a, b);
+        check(!g.intersecting && near(g.distance, distance), "gjk against every vertex and edge pair", k);
+        check(!m.intersecting && near(m.distance, distance), "gjk through maps against every pair", k);
+        const Point gap = g.pointB - g.pointA;
+        check(near(std::sqrt(dot(gap, gap)), distance), "gjk closest points are the distance apart", k);
+    }
+}
+
+//a warm start may only save iterations, never change the answer
+void testGjkWarmStart()
+{
+    Random r(28);
+    std::vector<Point> a, b;
+    for (size_t k = 0; k < 500; k++) {
+        randomPair(r, a, b);
+        GjkCache gjkCache, epaCache;
+        for (size_t step = 0; step < 40; step++) {
+            const Point v = { r.unit() - 0.5, r.unit() - 0.5 };
+            for (Point& p : b) {
+                p = p + v;
+            }
+            if (std::fabs(originDepth(bruteDifference(a, b))) < 1e-9) {
+                continue;
+            }
+            const GjkResult cold = gjk(a.data(), a.size(), b.data(), b.size());
+            const GjkResult warm = gjk(a.data(), a.size(), b.data(), b.size(), &gjkCache);
+            check(warm.intersecting == cold.intersecting && near(warm.distance, cold.distance),
+                  "warm started gjk equals the cold one", k * 100 + step);
+            const EpaResult coldEpa = epa(a.data(), a.size(), b.data(), b.size());
+            const EpaResult warmEpa = epa(a.data(), a.size(), b.data(), b.size(), &epaCache);
+            check(warmEpa.intersecting == coldEpa.intersecting && near(warmEpa.depth, coldEpa.depth),
+                  "warm started epa equals the cold one", k * 100 + step);
+        }
+    }
+}
+
+//every vertex pair of an edge ties on its normal, the map may take either
+void testSupportMap()
+{
+    Random r(29);
+    for (size_t k = 0; k < 2000; k++) {
+        const std::vector<Point> cloud = k % 2 == 0
+            ? generatePoints(Distribution::UniformDisk, 1 + r.range(0, 2000), r.next())
+            : randomPolygon(r, { 0, 0 }, 1 + r.range(0, 20));
+        const std::vector<Point> hull = referenceHull(cloud.data(), cloud.size());
+        const SupportMap map(hull.data(), hull.size());
+        std::vector<Point> directions = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, -1 } };
+        for (size_t i = 0; i < hull.size(); i++) {
+            const Point e = hull[(i + 1) % hull.size()] - hull[i];
+            directions.push_back(e);
+            directions.push_back({ e.y, -e.x });
+        }
+        for (size_t i = 0; i < 20; i++) {
+            directions.push_back({ r.unit() - 0.5, r.unit() - 0.5 });
+        }
+        for (const Point& d : directions) {
+            double best = -infinity, scale = 0;
+            for (const Point& p : hull) {
+                best = std::max(best, dot(p, d));
+                scale = std::max(scale, std::fabs(p.x * d.x) + std::fabs(p.y * d.y));
+            }
+            const size_t i = map.extreme(d);
+            check(i < hull.size() && dot(hull[i], d) >= best - 1e-12 * scale, "SupportMap::extreme against every vertex", k);
+        }
+    }
+}
+
+/*B flies past or into a still A, turning as it goes. It must come within
+* the tolerance at the time reported, and at no time before it
+*/
+void testTimeOfImpact()
+{
+    Random r(30);
+    const double tolerance = 0.01;
+    std::vector<Point> a, b;
+    for (size_t k = 0; k < 500; k++) {
+        a = randomPolygon(r, { 0, 0 }, 1 + r.range(0, 20));
+        b = randomPolygon(r, { 80, (double)r.range(-40, 40) }, 1 + r.range(0, 20));
+        if (bruteDistance(a, b) <= tolerance) {
+            continue;
+        }
+        Motion still, flight;
+        for (const Point& p : b) {
+            flight.center = flight.center + (1.0 / b.size()) * p;
+        }
+        flight.velocity = { -160, (double)r.range(-40, 40) };
+        flight.angularVelocity = (r.unit() - 0.5) * 8;
+        const ToiResult t = timeOfImpact(a.data(), a.size(), still, b.data(), b.size(), flight, 1.0, tolerance);
+
+        const auto distanceAt = [&](double time) {
+            std::vector<Point> moved = b;
+            for (Point& p : moved) {
+                p = flight.at(p, time);
+            }
+            return bruteDistance(a, moved);
+        };
+        if (t.hit) {
+            check(distanceAt(t.time) <= tolerance * (1 + 1e-6), "time of impact is within the tolerance", k);
+        }
+        else {
+            check(t.time == 1.0 || t.iterations >= 64, "no impact runs to the end unless it gives up", k);
+        }
+        for (size_t s = 0; s < 200; s++) {
+            const double time = t.time * s / 200;
+            check(distanceAt(time) > 0.25 * tolerance, "apart before the time of impact", k * 1000 + s);
+        }
+
+        const SupportMap mapA(a.data(), a.size()), mapB(b.data(), b.size());
+        const ToiResult m = timeOfImpact(mapA, still, mapB, flight, 1.0, tolerance);
+        check(m.hit == t.hit && near(m.time, t.time), "time of impact through maps", k);
+    }
+}
+
+//---- broad phase ---------------------------------------------------------
+
+//integer boxes, so many of them share an endpoint and only touch
+Aabb randomBox(Random& r)
+{
+    const Point min = { (double)r.range(0, 100), (double)r.range(0, 100) };
+    return { min, { min.x + r.range(0, 15), min.y + r.range(0, 15) } };
+}
+
+void testSweepAndPrune()
+{
+    Random r(31);
+    for (size_t trial = 0; trial < 20; trial++) {
+        SweepAndPrune sweep;
+        std::vector<Aabb> boxes;
+        std::vector<bool> alive;
+        for (size_t step = 0; step < 200; step++) {
+            const int64_t op = r.range(0, 3);
+            if (op == 0 || boxes.empty()) {
+                const Aabb box = randomBox(r);
+                const size_t id = sweep.add(box);
+                if (id >= boxes.size()) {
+                    boxes.resize(id + 1);
+                    alive.resize(id + 1, false);
+                }
+                check(!alive[id], "SweepAndPrune::add gives a free id", step);
+                boxes[id] = box;
+                alive[id] = true;
+            }
+            else {
+                const size_t id = r.range(0, boxes.size() - 1);
+                if (!alive[id]) {
+                    continue;
+                }
+                if (op == 1) {
+                    sweep.remove(id);
+                    alive[id] = false;
+                }
+                else {
+                    boxes[id] = randomBox(r);
+                    sweep.update(id, boxes[id]);
+                }
+            }
+
+            std::vector<std::pair<size_t, size_t>> pairs, expected;
+            sweep.findPairs(pairs);
+            std::sort(pairs.begin(), pairs.end());
+            for (size_t i = 0; i < boxes.size(); i++) {
+                for (size_t j = i + 1; j < boxes.size(); j++) {
+                    if (alive[i] && alive[j] && overlaps(boxes[i], boxes[j])) {
+                        expected.push_back({ i, j });
+                    }
+                }
+            }
+            check(pairs == expected, "SweepAndPrune pairs against every pair of boxes", trial * 1000 + step);
+        }
+    }
+}
+
+/*Bodies moved, replaced and removed between queries, each query checked
+* against every pair: the broad phase must pass on exactly the pairs whose
+* boxes grown by half the margin overlap, and the contacts are the pairs
+* within margin. Pairs within 1e-9 of the margin could go either way.
+*/
+void testCollisionWorld()
+{
+    Random r(32);
+    TaskPool pool(4);
+    for (size_t trial = 0; trial < 10; trial++) {
+        CollisionWorld world;
+        std::vector<bool> alive;
+        for (size_t k = 0; k < 40; k++) {
+            alive.push_back(true);
+            world.addBody(randomPolygon(r, { r.unit() * 200, r.unit() * 200 }, 1 + r.range(0, 12)));
+        }
+        for (size_t step = 0; step < 30; step++) {
+            for (size_t k = 0; k < 10; k++) {
+                const size_t id = r.range(0, alive.size() - 1);
+                if (!alive[id]) {
+                    continue;
+                }
+                const int64_t op = r.range(0, 5);
+                if (op == 0) {
+                    world.removeBody(id);
+                    alive[id] = false;
+                }
+                else if (op == 1) {
+                    world.setBody(id, randomPolygon(r, { r.unit() * 200, r.unit() * 200 }, 1 + r.range(0, 12)));
+                }
+                else {
+                    world.translateBody(id, { (r.unit() - 0.5) * 20, (r.unit() - 0.5) * 20 });
+                }
+            }
+
+            const double margin = step % 3 == 0 ? 0 : r.unit() * 10;
+            const std::vector<CollisionWorld::Contact> contacts = world.query(margin, step % 2 == 0 ? &pool : nullptr);
+            std::vector<std::pair<size_t, size_t>> found;
+            for (const CollisionWorld::Contact& c : contacts) {
+                found.push_back({ c.a, c.b });
+            }
+            std::sort(found.begin(), found.end());
+            check(std::adjacent_find(found.begin(), found.end()) == found.end(), "CollisionWorld reports a pair once", step);
+
+            size_t boxPairs = 0;
+            for (size_t i = 0; i < alive.size(); i++) {
+                for (size_t j = i + 1; j < alive.size(); j++) {
+                    if (!alive[i] || !alive[j]) {
+                        continue;
+                    }
+                    const std::vector<Point>& a = world.body(i);
+                    const std::vector<Point>& b = world.body(j);
+                    Aabb boxA = boundsOf(a.data(), a.size()), boxB = boundsOf(b.data(), b.size());
+                    boxA.max = boxA.max + Point{ margin, margin };
+                    boxB.max = boxB.max + Point{ margin, margin };
+                    boxPairs += overlaps(boxA, boxB);
+
+                    const double depth = originDepth(bruteDifference(a, b));
+                    bool expected;
+                    if (depth > 1e-9) {
+                        expected = true;
+                    }
+                    else if (depth < -1e-9) {
+                        const double distance = pairDistance(a, b);
+                        if (std::fabs(distance - margin) < 1e-9) {
+                            continue;
+                        }
+                        expected = distance <= margin;
+                    }
+                    else {
+                        continue;
+                    }
+                    const bool reported = std::binary_search(found.begin(), found.end(), std::make_pair(i, j));
+                    check(reported == expected, "CollisionWorld contacts against every pair", trial * 100000 + i * 100 + j);
+                }
+            }
+            check(world.candidateCount() == boxPairs, "CollisionWorld broad phase against every pair of boxes", trial * 1000 + step);
+        }
+    }
+}
+
+//---- point files and streams ---------------------------------------------
+
+//written next to the test binary and removed again
+const char* const scratchFile = "hulltest-scratch.pts";
+
+void testPointFileRoundTrip()
+{
+    Random r(33);
+    for (const NamedInput& input : inputs) {
+        for (size_t n : { (size_t)0, (size_t)1, (size_t)2, (size_t)100, (size_t)5000 }) {
+            std::vector<Point> pts = input.make(r, n);
+            for (Scalar type : { Scalar::Float64, Scalar::Float32 }) {
+                const std::string what = std::string("point file round trip of ") + input.name;
+                check(writePointFile(scratchFile, pts.data(), n, type), "writePointFile", n);
+                MappedPoints file;
+                if (!file.open(scratchFile)) {
+                    check(false, file.error().c_str(), n);
+                    continue;
+                }
+                check(file.size() == n && file.scalar() == type, what.c_str(), n);
+                bool same = true;
+                std::vector<Point> stored(n);
+                for (size_t i = 0; i < n; i++) {
+                    if (type == Scalar::Float64) {
+                        stored[i] = { file.xFloat64()[i], file.yFloat64()[i] };
+                        same = same && stored[i] == pts[i];
+                    }
+                    else {
+                        stored[i] = { file.xFloat32()[i], file.yFloat32()[i] };
+                        same = same && stored[i].x == (float)pts[i].x && stored[i].y == (float)pts[i].y;
+                    }
+                }
+                check(same, what.c_str(), n);
+
+                //the engines on the mapped columns give the hull of what was stored
+                const std::vector<size_t> hull = type == Scalar::Float64
+                    ? quickHull(file.xFloat64(), file.yFloat64(), n)
+                    : quickHull(file.xFloat32(), file.yFloat32(), n);
+                check(sameHull(stored.data(), hull, referenceHull(stored.data(), n)), "quickHull on mapped columns", n);
+            }
+        }
+    }
+    std::remove(scratchFile);
+}
+
+bool writeBytes(const std::vector<unsigned char>& bytes)
+{
+    FILE* f = std::fopen(scratchFile, "wb");
+    if (!f) {
+        return false;
+    }
+    const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+//every truncation and every damaged header field has to be refused with a message
+void testPointFileCorrupt()
+{
+    Random r(34);
+    const std::vector<Point> pts = uniform(r, 100);
+    check(writePointFile(scratchFile, pts.data(), pts.size(), Scalar::Float64), "writePointFile");
+    std::vector<unsigned char> good;
+    if (FILE* f = std::fopen(scratchFile, "rb")) {
+        int c;
+        while ((c = std::fgetc(f)) != EOF) {
+            good.push_back((unsigned char)c);
+        }
+        std::fclose(f);
+    }
+    check(good.size() >= sizeof(PointFileHeader) + 2 * 8 * pts.size(), "point file holds both columns", good.size());
+
+    const auto refused = [](const char* what, size_t detail) {
+        MappedPoints file;
+        check(!file.open(scratchFile) && !file.error().empty() && !file.isOpen(), what, detail);
+    };
+    for (size_t length : { (size_t)0, (size_t)8, (size_t)63, (size_t)64, (size_t)100, good.size() / 2, good.size() - 1 }) {
+        writeBytes(std::vector<unsigned char>(good.begin(), good.begin() + length));
+        refused("truncated point file", length);
+    }
+
+    PointFileHeader header;
+    std::memcpy(&header, good.data(), sizeof(header));
+    check(checkPointFileHeader(header, good.size()) == nullptr, "header of a good file passes");
+    for (int field = 0; field < 8; field++) {
+        PointFileHeader bad = header;
+        switch (field) {
+        case 0: bad.magic[0] = 'X'; break;
+        case 1: bad.version = pointFileVersion + 1; break;
+        case 2: bad.scalar = 5; break;
+        case 3: bad.count = header.count + 1; break;
+        case 4: bad.count = UINT64_MAX / 4; break;
+        case 5: bad.xOffset = header.xOffset + 3; break;
+        case 6: bad.yOffset = good.size(); break;
+        case 7: bad.xOffset = 8; break;
+        }
+        check(checkPointFileHeader(bad, good.size()) != nullptr, "corrupt header field", field);
+        std::vector<unsigned char> bytes = good;
+        std::memcpy(bytes.data(), &bad, sizeof(bad));
+        writeBytes(bytes);
+        refused("point file with a corrupt header", field);
+    }
+
+    writeBytes(good);
+    MappedPoints file;
+    check(file.open(scratchFile) && file.size() == pts.size(), "the untouched file still opens");
+    file.close();
+    std::remove(scratchFile);
+}
+
+/*The same points through StreamingHull with small chunks, as text and as
+* raw doubles through streamHull(), and from a point file, each against a
+* one-shot quickHull(). The text is long enough to be read in several blocks
+*/
+void testStreamHull()
+{
+    Random r(35);
+    for (const NamedInput& input : inputs) {
+        const std::vector<Point> pts = input.make(r, 20000);
+        const std::vector<Point> expected = hullPoints(pts.data(), pts.size());
+        const std::string what = std::string("streamed hull of ") + input.name;
+
+        for (size_t chunk : { (size_t)1, (size_t)7, (size_t)1000, (size_t)1 << 20 }) {
+            StreamingHull hull(chunk);
+            for (size_t i = 0; i < pts.size(); i += 3) {
+                hull.add(pts.data() + i, std::min((size_t)3, pts.size() - i));
+            }
+            hull.flush();
+            check(hull.vertices() == expected && hull.count() == pts.size(), what.c_str(), chunk);
+            bool indexed = hull.indices().size() == hull.vertices().size();
+            for (size_t k = 0; indexed && k < hull.indices().size(); k++) {
+                indexed = hull.indices()[k] < pts.size() && pts[hull.indices()[k]] == hull.vertices()[k];
+            }
+            check(indexed, "StreamingHull::indices point at the vertices", chunk);
+        }
+
+        for (StreamFormat format : { StreamFormat::Text, StreamFormat::Interleaved64 }) {
+            FILE* f = std::tmpfile();
+            if (!f) {
+                check(false, "tmpfile");
+                return;
+            }
+            for (const Point& p : pts) {
+                if (format == StreamFormat::Text) {
+                    std::fprintf(f, "%.17g %.17g\n", p.x, p.y);
+                }
+                else {
+                    std::fwrite(&p.x, sizeof(double), 1, f);
+                    std::fwrite(&p.y, sizeof(double), 1, f);
+                }
+            }
+            std::rewind(f);
+            StreamingHull hull(4096);
+            std::string error;
+            check(streamHull(f, format, hull, &error) && hull.vertices() == expected, what.c_str(), (size_t)format);
+            std::fclose(f);
+        }
+
+        //a float32 file holds rounded points, its hull is theirs
+        check(writePointFile(scratchFile, pts.data(), pts.size(), Scalar::Float32), "writePointFile");
+        std::vector<Point> rounded(pts.size());
+        for (size_t i = 0; i < pts.size(); i++) {
+            rounded[i] = { (float)pts[i].x, (float)pts[i].y };
+        }
+        StreamingHull fromFile(1000);
+        std::string error;
+        check(streamPointFile(scratchFile, fromFile, &error) && fromFile.vertices() == hullPoints(rounded.data(), rounded.size()),
+              "streamPointFile against quickHull", 0);
+    }
+    std::remove(scratchFile);
+
+    const char* const malformed[] = { "1 2 3 x", "1 2 3" };
+    for (const char* text : malformed) {
+        FILE* f = std::tmpfile();
+        if (!f) {
+            continue;
+        }
+        std::fputs(text, f);
+        std::rewind(f);
+        StreamingHull hull;
+        std::string error;
+        check(!streamHull(f, StreamFormat::Text, hull, &error) && !error.empty(), "streamHull refuses malformed text");
+        std::fclose(f);
+    }
+}
+
+struct Test
+{
+    const char* name;
+    void (*run)();
+};
+
+const Test tests[] = {
+    { "orient-ulp-grid", testOrientUlpGrid },
+    { "orient-near-collinear", testOrientNearCollinear },
+    { "incircle-cocircular", testIncircleCocircular },
+    { "incircle-random", testIncircleRandom },
+    { "hull-engines", testHullEngines },
+    { "hull-parallel", testParallelHull },
+    { "hull-batch", testHullBatch },
+    { "kinetic-moves", testKineticMoves },
+    { "dynamic-updates", testDynamicHull },
+    { "sliding-window", testSlidingWindow },
+    { "int-hull", testIntHull },
+    { "int-minkowski-sum", testIntMinkowskiSum },
+    { "pool-exception", testPoolException },
+    { "disc-contained", testDiscHullContained },
+    { "disc-grid", testDiscHullGrid },
+    { "pick-rank", testPickRank },
+    { "minkowski-difference", testMinkowskiDifference },
+    { "epa-depth", testEpaDepth },
+    { "gjk-distance", testGjkDistance },
+    { "gjk-warm-start", testGjkWarmStart },
+    { "support-map", testSupportMap },
+    { "time-of-impact", testTimeOfImpact },
+    { "sweep-and-prune", testSweepAndPrune },
+    { "collision-world", testCollisionWorld },
+    { "pointfile-round-trip", testPointFileRoundTrip },
+    { "pointfile-corrupt", testPointFileCorrupt },
+    { "stream-hull", testStreamHull },
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t ran = 0;
+    for (const Test& t : tests) {
+        bool wanted = argc < 2;
+        for (int a = 1; a < argc; a++) {
+            wanted = wanted || std::strstr(t.name, argv[a]) != nullptr;
+        }
+        if (!wanted) {
+            continue;
+        }
+        current = t.name;
+        const size_t before = failures;
+        t.run();
+        std::printf("%-24s %s\n", t.name, failures == before ? "ok" : "FAILED");
+        ran++;
+    }
+    std::printf("%zu tests, %zu failed checks\n", ran, failures);
+    return failures == 0 ? 0 : 1;
+}
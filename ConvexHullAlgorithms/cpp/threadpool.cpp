@@ -0,0 +1,139 @@
+#include "threadpool.h"
+
+namespace geom {
+
+namespace {
+
+//which pool (if any) the current thread is a worker of, and its deque
+thread_local const TaskPool* currentPool = nullptr;
+thread_local size_t          currentQueue = 0;
+
+}
+
+TaskPool::TaskPool(unsigned threads) : queued(0), stopping(false)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 0; i + 1 < threads; i++) {
+        workers.emplace_back(&TaskPool::workerLoop, this, i);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> l(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+TaskPool& TaskPool::shared()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+size_t TaskPool::queueIndex() const
+{
+    return currentPool == this ? currentQueue : queues.size() - 1;
+}
+
+void TaskPool::spawn(TaskGroup& group, std::function<void()> task)
+{
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    //counted before it is visible so a thief can never take queued below zero
+    queued.fetch_add(1, std::memory_order_release);
+    Queue& q = *queues[queueIndex()];
+    {
+        std::lock_guard<std::mutex> l(q.lock);
+        q.tasks.push_back({ std::move(task), &group });
+    }
+    {
+        //empty critical section orders this against a worker about to sleep
+        std::lock_guard<std::mutex> l(sleepLock);
+    }
+    wake.notify_one();
+}
+
+bool TaskPool::runOne(size_t self)
+{
+    Task task;
+    bool found = false;
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> l(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (size_t i = 1; !found && i < queues.size(); i++) {
+        Queue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> l(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    try {
+        task.run();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> l(task.group->errorLock);
+        if (!task.group->error) {
+            task.group->error = std::current_exception();
+        }
+    }
+    task.group->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void TaskPool::wait(TaskGroup& group)
+{
+    const size_t self = queueIndex();
+    while (group.pending.load(std::memory_order_acquire) != 0) {
+        if (!runOne(self)) {
+            std::this_thread::yield();
+        }
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> l(group.errorLock);
+        std::swap(error, group.error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskPool::workerLoop(size_t self)
+{
+    currentPool = this;
+    currentQueue = self;
+    for (;;) {
+        if (runOne(self)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> l(sleepLock);
+        wake.wait(l, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+}
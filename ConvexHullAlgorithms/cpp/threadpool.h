@@ -0,0 +1,116 @@
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace geom {
+
+/*Counts the tasks spawned into it that have not finished yet, and keeps the
+* first exception one of them threw so wait() can rethrow it
+*
+* @see TaskPool::spawn, TaskPool::wait
+*/
+class TaskGroup
+{
+public:
+    TaskGroup() : pending(0) {}
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+private:
+    friend class TaskPool;
+    std::atomic<size_t> pending;
+    std::mutex          errorLock;
+    std::exception_ptr  error;
+};
+
+/*Work-stealing thread pool for fork/join style recursion.
+*
+* Every worker owns a deque: it pushes and pops its own work at the back
+* (newest first, so recursion stays depth-first and cache warm) while idle
+* workers steal from the front of other deques (oldest first, which are the
+* biggest pieces of a divide and conquer). Threads that call wait() run
+* tasks too, so a task may spawn children and wait for them without
+* blocking a worker.
+*/
+class TaskPool
+{
+public:
+    //threads is the total parallelism including the thread calling wait(), 0 = one per core
+    explicit TaskPool(unsigned threads = 0);
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    //number of threads that can run tasks at once
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    void spawn(TaskGroup& group, std::function<void()> task);
+
+    /*Runs queued tasks on this thread until everything in group has finished.
+    * A task that throws still counts as finished, the first exception thrown
+    * by a task of group is rethrown here once the rest are done.
+    */
+    void wait(TaskGroup& group);
+
+    /*Calls body(lo, hi) over [begin, end) in chunks of at most grain, in parallel
+    */
+    template <class F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F body)
+    {
+        grain = std::max<size_t>(grain, 1);
+        if (end - begin <= grain || size() == 1) {
+            body(begin, end);
+            return;
+        }
+        TaskGroup group;
+        for (size_t lo = begin; lo < end; lo += grain) {
+            const size_t hi = std::min(end, lo + grain);
+            spawn(group, [&body, lo, hi] { body(lo, hi); });
+        }
+        wait(group);
+    }
+
+    //process wide pool sized to the machine
+    static TaskPool& shared();
+
+private:
+    struct Task
+    {
+        std::function<void()> run;
+        TaskGroup*            group;
+    };
+
+    struct Queue
+    {
+        std::mutex       lock;
+        std::deque<Task> tasks;
+    };
+
+    size_t queueIndex() const;
+    bool   runOne(size_t self);
+    void   workerLoop(size_t self);
+
+    //one deque per worker plus a final one for threads outside the pool
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread>            workers;
+
+    std::atomic<size_t>     queued;
+    std::mutex              sleepLock;
+    std::condition_variable wake;
+    bool                    stopping;
+};
+
+}
+
+#endif